@@ -13,6 +13,7 @@ struct API {
 
     struct compiled_t {
         std::vector<Command> commands;
+        std::vector<Instr> code;
         Type result;
         Runtime rt;
     };
@@ -23,14 +24,16 @@ struct API {
         TypeRuntime typer(debuglevel >= 2 ? true : false);
         out.result = parse(beg, end, input, typer, out.commands, debuglevel);
 
-        out.rt.init(typer.num_vars());
-
         execute_init<SORTED>(out.commands);
+
+        out.rt.init(typer.num_vars(), execute_alloc(out.commands));
+
+        execute_lower(out.commands, out.code);
     }
 
     static obj::Object* run(compiled_t& code, obj::Object* input) {
 
-        return execute<SORTED>(code.commands, code.rt, input);
+        return execute<SORTED>(code.code, code.rt, input);
     }
 
     static obj::Object* make(const Type& t) {
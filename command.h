@@ -61,6 +61,9 @@ struct Command {
 
     struct Closure {
         std::vector<Command> code;
+        UInt reg;
+
+        Closure() : reg(0) {}
 
         void swap(Closure& c) {
             code.swap(c.code);
@@ -72,11 +75,14 @@ struct Command {
     Type type;
     obj::Object* object;
     void* function;
-    
-    Command(cmd_t c = VAL) : cmd(c), object(nullptr), function(nullptr) {}
+
+    // Register of the first operand; the result goes to the same register.
+    UInt reg;
+
+    Command(cmd_t c = VAL) : cmd(c), object(nullptr), function(nullptr), reg(0) {}
 
     template <typename T>
-    Command(cmd_t c, const T& t) : cmd(c), arg(t), object(nullptr), function(nullptr) {}
+    Command(cmd_t c, const T& t) : cmd(c), arg(t), object(nullptr), function(nullptr), reg(0) {}
 
     static std::string print(cmd_t c) {
         switch (c) {
@@ -2,9 +2,20 @@
 #define __TAB_DEPS_H
 
 #include <math.h>
+#include <cmath>
 #include <time.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include <memory>
+#include <atomic>
 #include <stdexcept>
 #include <functional>
 #include <string>
@@ -14,8 +25,10 @@
 #include <map>
 #include <initializer_list>
 #include <utility>
+#include <typeinfo>
 #include <algorithm>
 #include <random>
+#include <limits>
 
 #include <regex>
 
@@ -23,5 +36,7 @@
 #include <fstream>
 
 #include <cstring>
+#include <cerrno>
+#include <cfloat>
 
 #endif
@@ -5,10 +5,11 @@ namespace tab {
 
 struct Runtime {
     std::vector<obj::Object*> vars;
-    std::vector<obj::Object*> stack;
+    std::vector<obj::Object*> regs;
 
-    void init(size_t nvars) {
+    void init(size_t nvars, size_t nregs) {
         vars.resize(nvars);
+        regs.resize(nregs);
     }
     
     void set_var(UInt ix, obj::Object* o) {
@@ -20,6 +21,134 @@ struct Runtime {
     }
 };
 
+// The commands are lowered into a flat array of compact instructions for
+// running: just the opcode, registers and the resolved object and function
+// pointers, without the types and closures the compiler needs. Every block
+// of code ends with an END instruction; closures are laid out after the
+// code that uses them, and generator instructions point at their closure.
+
+struct Instr {
+
+    enum {
+        END = Command::LAMD + 1
+    };
+
+    uint32_t op;
+    uint32_t reg;
+
+    // Variable index or tuple size.
+    uint32_t arg;
+
+    // Register holding the closure's result.
+    uint32_t out;
+
+    obj::Object* object;
+
+    // Resolved function, or the closure's code.
+    void* function;
+};
+
+void execute_run(Instr* ip, Runtime& r);
+
+// The sequence produced by '[ expr : seq ]': runs the closure for each
+// element of 'seq'.
+//
+// When a generator reads straight from another generator, as in
+// '[ f(@) : [ g(@) : seq ] ]', the two are fused: the outer generator takes
+// over the source and the closures of the inner one and runs all of them
+// in a single loop per element.
+
+struct Generator : public obj::SeqBase {
+
+    struct stage_t {
+        Instr* code;
+        UInt var;
+        UInt out;
+        bool tolerant;
+    };
+
+    Runtime* r;
+    obj::Object* seq;
+    std::vector<stage_t> stages;
+
+    // Set when the source is always the generator just before this one.
+    bool fuse;
+
+    Generator() : r(nullptr), seq(nullptr), fuse(false) {}
+
+    void start(obj::Object* src, const Instr* ip, Runtime& rt) {
+
+        r = &rt;
+
+        if (fuse) {
+            const Generator& inner = obj::get<Generator>(src);
+            seq = inner.seq;
+            stages = inner.stages;
+
+        } else {
+            seq = src;
+            stages.clear();
+        }
+
+        stages.push_back(stage_t{(Instr*)ip->function, ip->arg, ip->out, ip->op == Command::GEN_TRY});
+    }
+
+    void wrap(obj::Object* o) {
+        throw std::runtime_error("Sanity error: sequence wrapping a generator.");
+    }
+
+    obj::Object* next() {
+
+        while (1) {
+
+            obj::Object* x = seq->next();
+
+            if (!x) return x;
+
+            for (const stage_t& s : stages) {
+
+                r->set_var(s.var, x);
+
+                SoftErrors& se = soft_errors();
+
+                if (s.tolerant) {
+                    bool armed = se.armed;
+                    se.armed = true;
+
+                    try {
+                        execute_run(s.code, *r);
+
+                    } catch (...) {
+                        se.failed = true;
+                    }
+
+                    se.armed = armed;
+
+                    if (se.failed) {
+                        se.failed = false;
+                        x = nullptr;
+                        break;
+                    }
+
+                } else {
+                    execute_run(s.code, *r);
+
+                    // We are being pulled by a builtin from inside an enclosing 'try',
+                    // and that builtin wouldn't know to stop.
+                    if (se.failed) {
+                        se.failed = false;
+                        throw std::runtime_error("Element failed");
+                    }
+                }
+
+                x = r->regs[s.out];
+            }
+
+            if (x) return x;
+        }
+    }
+};
+
 template <bool SORTED>
 void execute_init(std::vector<Command>& commands) {
 
@@ -62,7 +191,7 @@ void execute_init(std::vector<Command>& commands) {
 
         case Command::GEN:
         case Command::GEN_TRY:
-            c.object = new obj::SeqGenerator;
+            c.object = new Generator;
             break;
 
         case Command::REC:
@@ -77,379 +206,450 @@ void execute_init(std::vector<Command>& commands) {
     }
 }
 
+// Operands are not pushed and popped at runtime; instead, since the stack
+// depth before every command is known at compile time, each command gets
+// the fixed register index of its first operand, and leaves its result in
+// that same register.
+//
+// A closure can run while the operands of the code that owns it are still
+// live (a generator is pulled from by some later command), so every closure
+// gets its own window of registers past those of its parent. Closures are
+// never re-entered, so one window per closure is enough.
+
+void stack_effect(const Command& c, UInt& pop, UInt& push) {
+
+    switch (c.cmd) {
+    case Command::FUN0:
+    case Command::VAR:
+    case Command::VAL:
+        pop = 0;
+        push = 1;
+        break;
+    case Command::VAW:
+        pop = 1;
+        push = 0;
+        break;
+    case Command::TUP:
+        pop = c.arg.uint;
+        push = 1;
+        break;
+    case Command::EQ:
+    case Command::LT:
+    case Command::EXP:
+    case Command::MUL_R:
+    case Command::MUL_I:
+    case Command::DIV_R:
+    case Command::DIV_I:
+    case Command::MOD:
+    case Command::ADD_R:
+    case Command::ADD_I:
+    case Command::SUB_R:
+    case Command::SUB_I:
+    case Command::AND:
+    case Command::OR:
+    case Command::XOR:
+        pop = 2;
+        push = 1;
+        break;
+    case Command::ROT:
+    case Command::I2R_2:
+    case Command::U2R_2:
+        pop = 2;
+        push = 2;
+        break;
+    case Command::LAMD:
+        pop = 0;
+        push = 0;
+        break;
+    default:
+        pop = 1;
+        push = 1;
+        break;
+    }
+}
+
+UInt execute_alloc(std::vector<Command>& commands, UInt base, UInt& top) {
+
+    UInt depth = base;
 
-void execute_run(std::vector<Command>& commands, Runtime& r) {
-    
     for (Command& c : commands) {
-        switch (c.cmd) {
 
-        case Command::FUN:
-        {
-            obj::Object* arg = r.stack.back();
-            r.stack.pop_back();
+        UInt pop;
+        UInt push;
+        stack_effect(c, pop, push);
 
-            ((Functions::func_t)c.function)(arg, c.object);
+        if (depth < base + pop)
+            throw std::runtime_error("Sanity error: stack underflow");
 
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::FUN0:
-        {
-            ((Functions::func_t)c.function)(nullptr, c.object);
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::VAR:
-        {
-            r.stack.push_back(r.get_var(c.arg.uint));
-            break;
-        }
-        case Command::VAW:
-        {
-            r.set_var(c.arg.uint, r.stack.back());
-            r.stack.pop_back();
-            break;
-        }
-        case Command::VAL:
-        {
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::TUP:
-        {
-            obj::Tuple& tup = obj::get<obj::Tuple>(c.object);
-            UInt nelem = c.arg.uint;
-            auto b = r.stack.end() - nelem;
-            auto e = r.stack.end();
-            tup.set(b, e);
-            r.stack.erase(b, e);
-            r.stack.push_back(c.object);
-            break;
+        c.reg = depth - pop;
+        depth = c.reg + push;
+        top = std::max(top, depth);
+    }
+
+    for (Command& c : commands) {
+
+        if (c.cmd != Command::GEN && c.cmd != Command::GEN_TRY && c.cmd != Command::REC)
+            continue;
+
+        Command::Closure& clo = c.closure[0];
+        clo.reg = top;
+
+        if (execute_alloc(clo.code, clo.reg, top) != clo.reg + 1)
+            throw std::runtime_error("Sanity error: closure did not produce result");
+    }
+
+    return depth;
+}
+
+// Returns the number of registers needed to run 'commands'.
+UInt execute_alloc(std::vector<Command>& commands) {
+
+    UInt top = 0;
+
+    if (execute_alloc(commands, 0, top) != 1)
+        throw std::runtime_error("Sanity error: did not produce result");
+
+    return top;
+}
+
+
+size_t execute_lower_block(const std::vector<Command>& commands, std::vector<Instr>& out) {
+
+    size_t start = out.size();
+
+    const Command* prev = nullptr;
+
+    for (const Command& c : commands) {
+
+        if (c.cmd == Command::LAMD)
+            continue;
+
+        if ((c.cmd == Command::GEN || c.cmd == Command::GEN_TRY) && prev != nullptr &&
+            (prev->cmd == Command::GEN || prev->cmd == Command::GEN_TRY) && prev->reg == c.reg) {
+
+            obj::get<Generator>(c.object).fuse = true;
         }
-        case Command::SEQ:
-        {
-            obj::Object* src = r.stack.back();
-            r.stack.pop_back();
-            c.object->wrap(src);
-            r.stack.push_back(c.object);
-            break;
+
+        prev = &c;
+
+        Instr i;
+        i.op = c.cmd;
+        i.reg = c.reg;
+        i.arg = (c.cmd == Command::VAL ? 0 : c.arg.uint);
+        i.out = 0;
+        i.object = c.object;
+        i.function = c.function;
+        out.push_back(i);
+    }
+
+    out.push_back(Instr{Instr::END, 0, 0, 0, nullptr, nullptr});
+
+    // Instruction addresses aren't stable until everything is laid out,
+    // so closures are linked by offset for now.
+    size_t n = start;
+
+    for (const Command& c : commands) {
+
+        if (c.cmd == Command::LAMD)
+            continue;
+
+        if (c.cmd == Command::GEN || c.cmd == Command::GEN_TRY || c.cmd == Command::REC) {
+
+            const Command::Closure& clo = c.closure[0];
+            size_t code = execute_lower_block(clo.code, out);
+
+            out[n].out = clo.reg;
+            out[n].function = (void*)code;
         }
-        case Command::GEN:
-        {
-            obj::Object* seq = r.stack.back();
-            r.stack.pop_back();
 
-            Command::Closure& clo = c.closure[0];
-            UInt var = c.arg.uint;
+        ++n;
+    }
 
-            obj::SeqGenerator& gen = obj::get<obj::SeqGenerator>(c.object);
+    return start;
+}
 
-            gen.v = [seq,&clo,var,&r]() mutable {
+void execute_lower(const std::vector<Command>& commands, std::vector<Instr>& out) {
 
-                obj::Object* next = seq->next();
+    out.clear();
+    execute_lower_block(commands, out);
 
-                if (!next) return next;
+    for (Instr& i : out) {
 
-                r.set_var(var, next);
+        if (i.op == Command::GEN || i.op == Command::GEN_TRY || i.op == Command::REC)
+            i.function = &out[(size_t)i.function];
+    }
+}
 
-                execute_run(clo.code, r);
+// Build with -DTAB_VM_STATS to count executed instructions.
 
-                obj::Object* val = r.stack.back();
-                r.stack.pop_back();
+#ifdef TAB_VM_STATS
+uint64_t& vm_instructions() {
+    static uint64_t n = 0;
+    return n;
+}
+#define TAB_VM_COUNT() ++vm_instructions()
+#else
+#define TAB_VM_COUNT()
+#endif
 
-                return val;
-            };
+#if defined(__GNUC__) && !defined(TAB_NO_COMPUTED_GOTO)
+#define TAB_COMPUTED_GOTO
+#endif
 
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::GEN_TRY:
-        {
-            obj::Object* seq = r.stack.back();
-            r.stack.pop_back();
+void execute_run(Instr* ip, Runtime& r) {
 
-            Command::Closure& clo = c.closure[0];
-            UInt var = c.arg.uint;
+    obj::Object** regs = r.regs.data();
 
-            obj::SeqGenerator& gen = obj::get<obj::SeqGenerator>(c.object);
+#define REG  regs[ip->reg]
+#define REG2 regs[ip->reg + 1]
 
-            gen.v = [seq,&clo,var,&r]() mutable {
+#ifdef TAB_COMPUTED_GOTO
 
-                while (1) {
+    static const void* labels[] = {
+        &&op_VAL, &&op_VAW, &&op_VAR,
+        &&op_EXP,
+        &&op_MUL_I, &&op_MUL_R, &&op_DIV_I, &&op_DIV_R, &&op_MOD,
+        &&op_ADD_I, &&op_ADD_R, &&op_SUB_I, &&op_SUB_R,
+        &&op_NOT, &&op_AND, &&op_OR, &&op_XOR,
+        &&op_I2R_1, &&op_I2R_2, &&op_U2R_1, &&op_U2R_2,
+        &&op_EQ, &&op_LT, &&op_NEG, &&op_ROT,
+        &&op_ARR, &&op_MAP, &&op_FUN, &&op_FUN0, &&op_SEQ, &&op_TUP,
+        &&op_GEN, &&op_GEN_TRY, &&op_REC, &&op_LAMD,
+        &&op_END
+    };
 
-                    obj::Object* next = seq->next();
+    static_assert(sizeof(labels) / sizeof(labels[0]) == Instr::END + 1, "Opcode table mismatch");
 
-                    if (!next) return next;
+#define OP(X) op_##X
+#define DISPATCH() TAB_VM_COUNT(); goto *labels[ip->op]
+#define NEXT() ++ip; DISPATCH()
 
-                    r.set_var(var, next);
+    DISPATCH();
 
-                    size_t oldsize = r.stack.size();
+#else
 
-                    try {
-                        execute_run(clo.code, r);
+#define OP(X) case Command::X
+#define NEXT() ++ip; continue
 
-                        obj::Object* val = r.stack.back();
-                        r.stack.pop_back();
-                        return val;
+    while (1) {
 
-                    } catch (...) {
-                        r.stack.resize(oldsize);
-                    }
-                }
-            };
+        TAB_VM_COUNT();
 
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::REC:
-        {
-            obj::Object* _in = r.stack.back();
-            r.stack.pop_back();
+        switch (ip->op) {
 
-            obj::Tuple& in = obj::get<obj::Tuple>(_in);
-            obj::Tuple& work = obj::get<obj::Tuple>(c.object);
-            UInt var = c.arg.uint;
-            r.set_var(var, &work);
+        case Instr::END:
+            return;
 
-            Command::Closure& clo = c.closure[0];
+#endif
 
-            work.v[0] = in.v[0]->clone();
+    OP(FUN):
+    {
+        ((Functions::func_t)ip->function)(REG, ip->object);
 
-            while (1) {
+        if (soft_errors().failed)
+            return;
 
-                obj::Object* next = in.v[1]->next();
+        REG = ip->object;
+        NEXT();
+    }
+    OP(FUN0):
+    {
+        ((Functions::func_t)ip->function)(nullptr, ip->object);
+        REG = ip->object;
+        NEXT();
+    }
+    OP(VAR):
+    {
+        REG = r.get_var(ip->arg);
+        NEXT();
+    }
+    OP(VAW):
+    {
+        r.set_var(ip->arg, REG);
+        NEXT();
+    }
+    OP(VAL):
+    {
+        REG = ip->object;
+        NEXT();
+    }
+    OP(TUP):
+    {
+        obj::Tuple& tup = obj::get<obj::Tuple>(ip->object);
+        tup.set(&REG, &REG + ip->arg);
+        REG = ip->object;
+        NEXT();
+    }
+    OP(SEQ):
+    {
+        ip->object->wrap(REG);
+        REG = ip->object;
+        NEXT();
+    }
+    OP(GEN):
+    OP(GEN_TRY):
+    {
+        obj::get<Generator>(ip->object).start(REG, ip, r);
+        REG = ip->object;
+        NEXT();
+    }
+    OP(REC):
+    {
+        obj::Tuple& in = obj::get<obj::Tuple>(REG);
+        obj::Tuple& work = obj::get<obj::Tuple>(ip->object);
+        r.set_var(ip->arg, &work);
 
-                if (!next) break;
+        Instr* code = (Instr*)ip->function;
 
-                work.v[1] = next;
+        work.v[0] = in.v[0]->clone();
 
-                execute_run(clo.code, r);
+        while (1) {
 
-                obj::Object* cloned = r.stack.back()->clone();
-                r.stack.pop_back();
-                delete work.v[0];
-                work.v[0] = cloned;
-            }
+            obj::Object* next = in.v[1]->next();
 
-            r.stack.push_back(work.v[0]);
-            break;
-        }
-        case Command::ARR:
-        {
-            obj::Object* seq = r.stack.back();
-            r.stack.pop_back();
-            obj::Object* dst = c.object;
+            if (!next) break;
 
-            dst->fill(seq);
+            work.v[1] = next;
 
-            r.stack.push_back(dst);
-            break;
-        }
-        case Command::MAP:
-        {
-            obj::Object* seq = r.stack.back();
-            r.stack.pop_back();
-            obj::Object* dst = c.object;
+            execute_run(code, r);
 
-            dst->fill(seq);
+            if (soft_errors().failed)
+                return;
 
-            r.stack.push_back(dst);
-            break;
+            obj::Object* cloned = regs[ip->out]->clone();
+            delete work.v[0];
+            work.v[0] = cloned;
         }
 
-        case Command::EQ:
-        {
-            obj::Object* a = r.stack.back();
-            r.stack.pop_back();
-            obj::Object* b = r.stack.back();
-            r.stack.pop_back();
-            obj::UInt& x = obj::get<obj::UInt>(c.object);
-            x.v = (b->eq(a) ? 1 : 0);
-            r.stack.push_back(c.object);
-            break;
-        }
+        REG = work.v[0];
+        NEXT();
+    }
+    OP(ARR):
+    OP(MAP):
+    {
+        ip->object->fill(REG);
+        REG = ip->object;
+        NEXT();
+    }
 
-        case Command::LT:
-        {
-            obj::Object* a = r.stack.back();
-            r.stack.pop_back();
-            obj::Object* b = r.stack.back();
-            r.stack.pop_back();
-            obj::UInt& x = obj::get<obj::UInt>(c.object);
-            x.v = (b->less(a) ? 1 : 0);
-            r.stack.push_back(c.object);
-            break;
-        }
+    OP(EQ):
+    {
+        obj::UInt& x = obj::get<obj::UInt>(ip->object);
+        x.v = (REG->eq(REG2) ? 1 : 0);
+        REG = ip->object;
+        NEXT();
+    }
 
-        case Command::NEG:
-        {
-            obj::UInt& x = obj::get<obj::UInt>(r.stack.back());
-            x.v = (x.v == 0 ? 1 : 0);
-            break;
-        }
+    OP(LT):
+    {
+        obj::UInt& x = obj::get<obj::UInt>(ip->object);
+        x.v = (REG->less(REG2) ? 1 : 0);
+        REG = ip->object;
+        NEXT();
+    }
 
-        case Command::ROT:
-        {
-            obj::Object* a = r.stack.back();
-            r.stack.pop_back();
-            obj::Object* b = r.stack.back();
-            r.stack.pop_back();
-            r.stack.push_back(a);
-            r.stack.push_back(b);
-            break;
-        }
-        
-        // And here comes the numeric operator boilerplate.
+    OP(NEG):
+    {
+        obj::UInt& x = obj::get<obj::UInt>(REG);
+        x.v = (x.v == 0 ? 1 : 0);
+        NEXT();
+    }
+
+    OP(ROT):
+    {
+        std::swap(REG, REG2);
+        NEXT();
+    }
+
+    // And here comes the numeric operator boilerplate.
 
 #define MATHOP(TYPE,EXPR)                               \
-        TYPE& a = obj::get<TYPE>(r.stack.back());       \
-        r.stack.pop_back();                             \
-        TYPE& b = obj::get<TYPE>(r.stack.back());       \
-        r.stack.pop_back();                             \
-        TYPE& x = obj::get<TYPE>(c.object);             \
+    {                                                   \
+        TYPE& b = obj::get<TYPE>(REG);                  \
+        TYPE& a = obj::get<TYPE>(REG2);                 \
+        TYPE& x = obj::get<TYPE>(ip->object);           \
         x.v = EXPR;                                     \
-        r.stack.push_back(c.object);
+        REG = ip->object;                               \
+        NEXT();                                         \
+    }
 
-        case Command::EXP:
-        {
-            MATHOP(obj::Real, ::pow(b.v, a.v));
-            break;
-        }
-        case Command::MUL_R:
-        {
-            MATHOP(obj::Real, b.v * a.v);
-            break;
-        }
-        case Command::MUL_I:
-        {
-            MATHOP(obj::Int, b.v * a.v);
-            break;
-        }
-        case Command::DIV_R:
-        {
-            MATHOP(obj::Real, b.v / a.v);
-            break;
-        }
-        case Command::DIV_I:
-        {
-            MATHOP(obj::Int, b.v / a.v);
-            break;
-        }
-        case Command::MOD:
-        {
-            MATHOP(obj::Int, b.v % a.v);
-            break;
-        }
-        case Command::ADD_R:
-        {
-            MATHOP(obj::Real, b.v + a.v);
-            break;
-        }
-        case Command::ADD_I:
-        {
-            MATHOP(obj::Int, b.v + a.v);
-            break;
-        }
-        case Command::SUB_R:
-        {
-            MATHOP(obj::Real, b.v - a.v);
-            break;
-        }
-        case Command::SUB_I:
-        {
-            MATHOP(obj::Int, b.v - a.v);
-            break;
-        }
-        case Command::AND:
-        {
-            MATHOP(obj::Int, b.v & a.v);
-            break;
-        }
-        case Command::OR:
-        {
-            MATHOP(obj::Int, b.v | a.v);
-            break;
-        }
-        case Command::XOR:
-        {
-            MATHOP(obj::Int, b.v ^ a.v);
-            break;
-        }
+    OP(EXP):   MATHOP(obj::Real, ::pow(b.v, a.v));
+    OP(MUL_R): MATHOP(obj::Real, b.v * a.v);
+    OP(MUL_I): MATHOP(obj::Int, b.v * a.v);
+    OP(DIV_R): MATHOP(obj::Real, b.v / a.v);
+    OP(DIV_I): MATHOP(obj::Int, b.v / a.v);
+    OP(MOD):   MATHOP(obj::Int, b.v % a.v);
+    OP(ADD_R): MATHOP(obj::Real, b.v + a.v);
+    OP(ADD_I): MATHOP(obj::Int, b.v + a.v);
+    OP(SUB_R): MATHOP(obj::Real, b.v - a.v);
+    OP(SUB_I): MATHOP(obj::Int, b.v - a.v);
+    OP(AND):   MATHOP(obj::Int, b.v & a.v);
+    OP(OR):    MATHOP(obj::Int, b.v | a.v);
+    OP(XOR):   MATHOP(obj::Int, b.v ^ a.v);
 
 #undef MATHOP
 
-        case Command::I2R_1:
-        {
-            obj::Int& a = obj::get<obj::Int>(r.stack.back());
-            r.stack.pop_back();
-            obj::Real& b = obj::get<obj::Real>(c.object);
-            b.v = a.v;
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::I2R_2:
-        {
-            obj::Object* x = r.stack.back();
-            r.stack.pop_back();
-            obj::Int& a = obj::get<obj::Int>(r.stack.back());
-            r.stack.pop_back();
-            obj::Real& b = obj::get<obj::Real>(c.object);
-            b.v = a.v;
-            r.stack.push_back(c.object);
-            r.stack.push_back(x);
-            break;
-        }
-        case Command::U2R_1:
-        {
-            obj::UInt& a = obj::get<obj::UInt>(r.stack.back());
-            r.stack.pop_back();
-            obj::Real& b = obj::get<obj::Real>(c.object);
-            b.v = a.v;
-            r.stack.push_back(c.object);
-            break;
-        }
-        case Command::U2R_2:
-        {
-            obj::Object* x = r.stack.back();
-            r.stack.pop_back();
-            obj::UInt& a = obj::get<obj::UInt>(r.stack.back());
-            r.stack.pop_back();
-            obj::Real& b = obj::get<obj::Real>(c.object);
-            b.v = a.v;
-            r.stack.push_back(c.object);
-            r.stack.push_back(x);
-            break;
-        }
-        
-        case Command::NOT:
-        {
-            obj::Int& a = obj::get<obj::Int>(r.stack.back());
-            r.stack.pop_back();
-            obj::Int& b = obj::get<obj::Int>(c.object);
-            b.v = ~a.v;
-            r.stack.push_back(c.object);
-            break;
-        }
+    OP(I2R_1):
+    OP(I2R_2):
+    {
+        obj::Int& a = obj::get<obj::Int>(REG);
+        obj::Real& b = obj::get<obj::Real>(ip->object);
+        b.v = a.v;
+        REG = ip->object;
+        NEXT();
+    }
+    OP(U2R_1):
+    OP(U2R_2):
+    {
+        obj::UInt& a = obj::get<obj::UInt>(REG);
+        obj::Real& b = obj::get<obj::Real>(ip->object);
+        b.v = a.v;
+        REG = ip->object;
+        NEXT();
+    }
+
+    OP(NOT):
+    {
+        obj::Int& a = obj::get<obj::Int>(REG);
+        obj::Int& b = obj::get<obj::Int>(ip->object);
+        b.v = ~a.v;
+        REG = ip->object;
+        NEXT();
+    }
+
+    OP(LAMD):
+    {
+        // This opcode is a no-op.
+        NEXT();
+    }
+
+#ifdef TAB_COMPUTED_GOTO
+
+    op_END:
+        return;
+
+#undef DISPATCH
+#else
 
-        case Command::LAMD:
-            // This opcode is a no-op.
-            break;
         }
     }
+
+#endif
+
+#undef OP
+#undef NEXT
+#undef REG
+#undef REG2
 }
 
 template <bool SORTED>
-obj::Object* execute(std::vector<Command>& commands, Runtime& rt, obj::Object* input) {
+obj::Object* execute(std::vector<Instr>& code, Runtime& rt, obj::Object* input) {
 
     rt.set_var(0, input);
-    rt.stack.clear();
-
-    execute_run(commands, rt);
 
-    if (rt.stack.size() != 1)
-        throw std::runtime_error("Sanity error: did not produce result");
+    execute_run(code.data(), rt);
 
-    return rt.stack.back();
+    return rt.regs[0];
 }
 
 } // namespace tab
@@ -0,0 +1,190 @@
+#ifndef __TAB_FLATMAP_H
+#define __TAB_FLATMAP_H
+
+namespace tab {
+
+// An open-addressing hash map with a subset of the std::unordered_map
+// interface.
+//
+// Entries are kept densely in a vector, in insertion order, together with
+// their full hash. The index is a power-of-two array of slots, each one
+// holding an entry number and the upper bits of that entry's hash; probing
+// is linear and almost never has to look at an entry that doesn't match.
+// Rehashing uses the cached hashes, so keys are never hashed twice.
+//
+// Erasing is not supported.
+
+template <typename K, typename V, typename H, typename E>
+struct FlatMap {
+
+    struct value_type {
+        K first;
+        V second;
+        hash_t hash;
+
+        value_type(const K& k, const V& v, hash_t h) : first(k), second(v), hash(h) {}
+    };
+
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    struct slot_t {
+        uint32_t index;
+        uint32_t tag;
+    };
+
+    static const uint32_t EMPTY = 0xFFFFFFFF;
+
+    std::vector<value_type> entries;
+    std::vector<slot_t> slots;
+    size_t shift;
+
+    FlatMap() : shift(0) {}
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    void clear() {
+
+        if (entries.empty())
+            return;
+
+        entries.clear();
+
+        for (slot_t& s : slots) {
+            s.index = EMPTY;
+        }
+    }
+
+    static uint32_t tag(hash_t h) {
+        return (uint32_t)((uint64_t)h >> 32) ^ (uint32_t)h;
+    }
+
+    size_t position(hash_t h) const {
+        // Fibonacci hashing, so that hashes with poorly mixed low bits still spread out.
+        return (size_t)(((uint64_t)h * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+
+    void rehash(size_t n) {
+
+        size_t bits = 4;
+
+        while (((size_t)1 << bits) < n) {
+            ++bits;
+        }
+
+        slots.assign((size_t)1 << bits, slot_t{EMPTY, 0});
+        shift = 64 - bits;
+
+        size_t mask = slots.size() - 1;
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+
+            hash_t h = entries[i].hash;
+            size_t p = position(h);
+
+            while (slots[p].index != EMPTY) {
+                p = (p + 1) & mask;
+            }
+
+            slots[p].index = i;
+            slots[p].tag = tag(h);
+        }
+    }
+
+    void reserve(size_t n) {
+
+        if (n * 4 > slots.size() * 3)
+            rehash(n * 4 / 3 + 1);
+
+        entries.reserve(n);
+    }
+
+    // Returns the slot holding 'k', or the empty slot where it belongs.
+    size_t probe(const K& k, hash_t h) const {
+
+        size_t mask = slots.size() - 1;
+        size_t p = position(h);
+        uint32_t t = tag(h);
+
+        while (1) {
+            const slot_t& s = slots[p];
+
+            if (s.index == EMPTY)
+                return p;
+
+            if (s.tag == t) {
+                const value_type& x = entries[s.index];
+
+                if (x.hash == h && E()(x.first, k))
+                    return p;
+            }
+
+            p = (p + 1) & mask;
+        }
+    }
+
+    iterator find(const K& k) {
+
+        if (entries.empty())
+            return entries.end();
+
+        size_t p = probe(k, H()(k));
+        uint32_t i = slots[p].index;
+
+        return (i == EMPTY ? entries.end() : entries.begin() + i);
+    }
+
+    const_iterator find(const K& k) const {
+        return const_cast<FlatMap*>(this)->find(k);
+    }
+
+    // Looks up 'k'; if it isn't there, inserts the key and value returned
+    // by 'make()'. (The new key must compare equal to 'k'.)
+    template <typename F>
+    std::pair<iterator, bool> find_or_insert(const K& k, hash_t h, F make) {
+
+        if ((entries.size() + 1) * 4 > slots.size() * 3)
+            rehash((entries.size() + 1) * 2);
+
+        size_t p = probe(k, h);
+        slot_t& s = slots[p];
+
+        if (s.index != EMPTY)
+            return std::make_pair(entries.begin() + s.index, false);
+
+        std::pair<K, V> x = make();
+        entries.emplace_back(x.first, x.second, h);
+
+        s.index = entries.size() - 1;
+        s.tag = tag(h);
+
+        return std::make_pair(entries.end() - 1, true);
+    }
+
+    std::pair<iterator, bool> insert_hashed(const K& k, const V& v, hash_t h) {
+        return find_or_insert(k, h, [&]() { return std::make_pair(k, v); });
+    }
+
+    // Entries taken from another FlatMap of the same type bring their hash along.
+    std::pair<iterator, bool> insert(const value_type& x) {
+        return insert_hashed(x.first, x.second, x.hash);
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V>& x) {
+        return insert_hashed(x.first, x.second, H()(x.first));
+    }
+
+    V& operator[](const K& k) {
+        return insert_hashed(k, V(), H()(k)).first->second;
+    }
+};
+
+}
+
+#endif
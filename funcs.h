@@ -3,6 +3,30 @@
 
 namespace tab {
 
+// Errors caused by bad input data (a string that isn't a number, a key
+// that isn't in the map, ...) are routine inside a 'try' generator, and
+// throwing an exception for every bad row is very slow. So builtins report
+// them with 'soft_fail()': when a 'try' is in effect the failure is only
+// recorded, the builtin returns at once and the VM abandons the element.
+// Otherwise the builtin throws as usual.
+
+struct SoftErrors {
+    bool armed;
+    bool failed;
+};
+
+SoftErrors& soft_errors() {
+    static thread_local SoftErrors ret = { false, false };
+    return ret;
+}
+
+// Returns false if the caller should throw instead.
+bool soft_fail() {
+    SoftErrors& s = soft_errors();
+    s.failed = s.armed;
+    return s.armed;
+}
+
 namespace funcs {
 
 #include "funcs/index.h"
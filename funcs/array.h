@@ -85,7 +85,9 @@ void array_from_map(const obj::Object* in, obj::Object*& out) {
 
     obj::MapObject<SORTED>& a = obj::get< obj::MapObject<SORTED> >(in);
     obj::ArrayObject& o = obj::get<obj::ArrayObject>(out);
-    
+
+    a.box();
+
     typename obj::MapObject<SORTED>::map_t::const_iterator b = a.v.begin();
     typename obj::MapObject<SORTED>::map_t::const_iterator e = a.v.end();
 
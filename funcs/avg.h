@@ -14,9 +14,12 @@ struct AtomAvg : public obj::Real {
         return ret;
     }
     
+    // 'o' may be a partial sum from an earlier merge, or (when an 'if'
+    // mixes aggregates with plain values) not an AtomAvg at all.
     void merge(const obj::Object* o) {
+        const AtomAvg* x = dynamic_cast<const AtomAvg*>(o);
         v += obj::get<obj::Real>(o).v;
-        n++;
+        n += (x ? x->n : 1);
     }
 
     void merge_end() {
@@ -42,6 +45,8 @@ struct AtomVar : public obj::Real {
         return ret;
     }
     
+    // 'o' is either a single data point or a partial sum (n > 1) from
+    // an earlier merge; partial sums are shifted to our K.
     void merge(const obj::Object* o) {
 
         if (n == 1) {
@@ -50,10 +55,20 @@ struct AtomVar : public obj::Real {
             v = 0;
         }
 
-        Real x = obj::get<obj::Real>(o).v - K;
-        v += x;
-        sumv2 += (x * x);
-        n++;
+        const AtomVar* x = dynamic_cast<const AtomVar*>(o);
+
+        if (!x || x->n == 1) {
+            Real d = obj::get<obj::Real>(o).v - K;
+            v += d;
+            sumv2 += (d * d);
+            n++;
+            return;
+        }
+
+        Real d = x->K - K;
+        sumv2 += x->sumv2 + 2 * d * x->v + x->n * d * d;
+        v += x->v + x->n * d;
+        n += x->n;
     }
 
     void merge_end() {
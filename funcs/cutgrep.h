@@ -1,6 +1,49 @@
 #ifndef __TUP_FUNCS_CUTGREP_H
 #define __TUP_FUNCS_CUTGREP_H
 
+// Builds a list of fields over the strings left in it from the previous
+// row, so that their memory is reused; splitting a row with the usual
+// number of fields then allocates nothing.
+
+struct Fields {
+
+    std::vector<std::string>& v;
+    size_t n;
+
+    Fields(std::vector<std::string>& x) : v(x), n(0) {}
+
+    template <typename I>
+    void add(I b, I e) {
+
+        if (n < v.size()) {
+            v[n].assign(b, e);
+        } else {
+            v.emplace_back(b, e);
+        }
+
+        ++n;
+    }
+
+    void add(const char* b, const char* e) {
+
+        if (n < v.size()) {
+            v[n].assign(b, e - b);
+        } else {
+            v.emplace_back(b, e - b);
+        }
+
+        ++n;
+    }
+
+    void add(const std::string& s) {
+        add(s.data(), s.data() + s.size());
+    }
+
+    void finish() {
+        v.resize(n);
+    }
+};
+
 void cut(const obj::Object* in, obj::Object*& out) {
 
     obj::Tuple& args = obj::get<obj::Tuple>(in);
@@ -8,121 +51,183 @@ void cut(const obj::Object* in, obj::Object*& out) {
     const std::string& str = obj::get<obj::String>(args.v[0]).v;
     const std::string& del = obj::get<obj::String>(args.v[1]).v;
 
-    size_t N = str.size();
-    size_t M = del.size();
+    if (del.empty())
+        throw std::runtime_error("Cannot use an empty delimiter in 'cut'.");
 
-    size_t prev = 0;
+    const char* prev = str.data();
+    const char* e = prev + str.size();
 
     obj::ArrayAtom<std::string>& vv = obj::get< obj::ArrayAtom<std::string> >(out);
-    std::vector<std::string>& v = vv.v;
-    
-    v.clear();
-    
-    for (size_t i = 0; i < N; ++i) {
+    Fields v(vv.v);
 
-        bool matched = true;
+    while (1) {
 
-        for (size_t j = 0; j < M; ++j) {
+        const char* i = scan::find_str(prev, e, del.data(), del.size());
 
-            if (i+j < N && str[i+j] == del[j])
-                continue;
-            
-            matched = false;
+        if (i == e)
             break;
-        }
 
-        if (matched) {
-            v.emplace_back(str.begin() + prev, str.begin() + i);
-            i += M;
-            prev = i;
-            --i;
-        }
+        v.add(prev, i);
+        prev = i + del.size();
     }
 
-    v.emplace_back(str.begin() + prev, str.end());
+    v.add(prev, e);
+    v.finish();
 }
 
-template <typename I>
-bool equal(I& b1, I& e1, I& b2, I& e2) {
+// Returns false if there are not enough fields.
+bool cutn_impl(const std::string& str, const std::string& del, size_t nth, std::string& out) {
 
-    if (e1 - b1 < e2 - b2)
-        return false;
+    const char* prev = str.data();
+    const char* e = prev + str.size();
 
-    return std::equal(b2, e2, b1);
-}
+    for (size_t n = 0; ; ++n) {
 
-template <typename I>
-void cutn_impl(I str_b, I str_e, I del_b, I del_e, size_t nth, std::string& out) {
+        const char* i = scan::find_str(prev, e, del.data(), del.size());
 
-    auto prev = str_b;
+        if (n == nth) {
+            out.assign(prev, i);
+            return true;
+        }
 
-    out.clear();
+        if (i == e)
+            return false;
 
-    UInt nmatch = 0;
+        prev = i + del.size();
+    }
+}
 
-    for (; str_b != str_e; ++str_b) {
+// Counts fields from the end.
+bool rcutn_impl(const std::string& str, const std::string& del, size_t nth, std::string& out) {
 
-        bool matched = equal(str_b, str_e, del_b, del_e);
+    const char* b = str.data();
+    const char* next = b + str.size();
 
-        if (matched) {
+    for (size_t n = 0; ; ++n) {
 
-            if (nth == nmatch) {
-                out.assign(prev, str_b);
-                return;
-            }
+        const char* i = scan::rfind_str(b, next, del.data(), del.size());
 
-            nmatch++;
-            str_b += (del_e - del_b);
-            prev = str_b;
-            --str_b;
+        if (n == nth) {
+            out.assign((i ? i + del.size() : b), next);
+            return true;
         }
+
+        if (!i)
+            return false;
+
+        next = i;
     }
+}
 
-    if (nth == nmatch) {
-        out.assign(prev, str_b);
-        return;
+bool cutn_impl(const std::string& str, const std::string& del, Int nth, std::string& out) {
+
+    if (nth >= 0)
+        return cutn_impl(str, del, (size_t)nth, out);
+
+    return rcutn_impl(str, del, -1 - nth, out);
+}
+
+// Whether two occurrences of 'del' can overlap, like "aa" in "aaa". If they
+// can't, splitting from either end finds the same fields.
+bool self_overlaps(const std::string& del) {
+
+    for (size_t k = 1; k < del.size(); ++k) {
+
+        if (::memcmp(del.data(), del.data() + k, del.size() - k) == 0)
+            return true;
     }
 
-    throw std::runtime_error("Substring not found in 'cut'");
+    return false;
 }
 
-template <typename NUM>
-void cutn(const obj::Object* in, obj::Object*& out);
+// Indexes into the full 'cut' result, where negative indexes count the
+// fields of the left-to-right split.
+bool cut_index_impl(const std::string& str, const std::string& del, UInt nth, std::string& out) {
+    return cutn_impl(str, del, (size_t)nth, out);
+}
 
-template <>
-void cutn<UInt>(const obj::Object* in, obj::Object*& out) {
+bool cut_index_impl(const std::string& str, const std::string& del, Int nth, std::string& out) {
+
+    if (nth >= 0 || !self_overlaps(del))
+        return cutn_impl(str, del, nth, out);
+
+    const char* b = str.data();
+    const char* e = b + str.size();
+    size_t fields = 1;
+
+    while (1) {
+        b = scan::find_str(b, e, del.data(), del.size());
+
+        if (b == e)
+            break;
+
+        b += del.size();
+        ++fields;
+    }
+
+    if ((size_t)(-1 - nth) >= fields)
+        return false;
+
+    return cutn_impl(str, del, (size_t)(fields + nth), out);
+}
+
+// With INDEX, works and fails like indexing into the full 'cut' result
+// would; the optimizer uses this for 'cut(s, d)[n]'.
+template <typename NUM, bool INDEX = false>
+void cutn(const obj::Object* in, obj::Object*& out) {
 
     obj::Tuple& args = obj::get<obj::Tuple>(in);
 
     const std::string& str = obj::get<obj::String>(args.v[0]).v;
     const std::string& del = obj::get<obj::String>(args.v[1]).v;
-    UInt nth = obj::get<obj::UInt>(args.v[2]).v;
+    NUM nth = obj::get< obj::Atom<NUM> >(args.v[2]).v;
+
+    if (del.empty())
+        throw std::runtime_error("Cannot use an empty delimiter in 'cut'.");
 
     std::string& v = obj::get<obj::String>(out).v;
 
-    cutn_impl(str.begin(), str.end(), del.begin(), del.end(), nth, v);
+    if ((INDEX ? cut_index_impl(str, del, nth, v) : cutn_impl(str, del, nth, v)) || soft_fail())
+        return;
+
+    if (INDEX)
+        throw std::runtime_error("Array index out of bounds");
+
+    throw std::runtime_error("Substring not found in 'cut'");
 }
 
-template <>
-void cutn<Int>(const obj::Object* in, obj::Object*& out) {
+// Splits off only the first 'limit' fields. The optimizer uses this when
+// a 'cut' result is only ever indexed with constants below 'limit'.
+void cut_limit(const obj::Object* in, obj::Object*& out) {
 
     obj::Tuple& args = obj::get<obj::Tuple>(in);
 
     const std::string& str = obj::get<obj::String>(args.v[0]).v;
     const std::string& del = obj::get<obj::String>(args.v[1]).v;
-    Int nth = obj::get<obj::Int>(args.v[2]).v;
+    UInt limit = obj::get<obj::UInt>(args.v[2]).v;
 
-    std::string& v = obj::get<obj::String>(out).v;
+    if (del.empty())
+        throw std::runtime_error("Cannot use an empty delimiter in 'cut'.");
 
-    if (nth >= 0) {
+    const char* prev = str.data();
+    const char* e = prev + str.size();
 
-        cutn_impl(str.begin(), str.end(), del.begin(), del.end(), nth, v);
+    obj::ArrayAtom<std::string>& vv = obj::get< obj::ArrayAtom<std::string> >(out);
+    Fields v(vv.v);
 
-    } else {
+    for (UInt n = 0; n < limit; ++n) {
 
-        cutn_impl(str.rbegin(), str.rend(), del.rbegin(), del.rend(), -1 - nth, v);
-        std::reverse(v.begin(), v.end());
+        const char* i = scan::find_str(prev, e, del.data(), del.size());
+
+        v.add(prev, i);
+
+        if (i == e)
+            break;
+
+        prev = i + del.size();
     }
+
+    v.finish();
 }
 
 template <void CUTTER(const obj::Object*, obj::Object*&)>
@@ -192,63 +297,97 @@ Functions::func_t cut_checker(const Type& args, Type& ret, obj::Object*& obj) {
 
 struct RegexCache {
 
-    std::unordered_map<std::string, std::regex> cache;
+    std::unordered_map< std::string, std::unique_ptr<regex::Regex> > cache;
 
-    const std::regex& get(const std::string& s) {
+    regex::Regex& get(const std::string& s) {
 
         auto i = cache.find(s);
 
         if (i == cache.end()) {
-            i = cache.insert(i, std::make_pair(s, std::regex(s, std::regex_constants::optimize)));
+            i = cache.insert(i, std::make_pair(s, std::unique_ptr<regex::Regex>(new regex::Regex(s))));
         }
 
-        return i->second;
+        return *(i->second);
     }
 };
 
-const std::regex& regex_cache(const std::string& s) {
+regex::Regex& regex_cache(const std::string& s) {
     static thread_local RegexCache cache;
     return cache.get(s);
 }
 
+// Calls 'f' with the capture pointers of every match in 's', in the same
+// order as 'std::sregex_iterator'.
+template <typename F>
+void regex_each(regex::Regex& rx, const std::string& s, F f) {
+
+    const char* b = s.data();
+    const char* e = b + s.size();
+
+    if (!rx.search(b, e))
+        return;
+
+    std::vector<const char*>& caps = rx.caps;
+    caps.resize(rx.nslots());
+
+    const char* i = b;
+
+    while (rx.find(b, i, e, caps.data())) {
+
+        f(caps.data());
+
+        i = caps[1];
+
+        // After an empty match, look for a non-empty one at the same place
+        // before moving on.
+        while (caps[0] == caps[1]) {
+
+            if (i == e)
+                return;
+
+            if (rx.find(b, i, e, caps.data(), true, true)) {
+                f(caps.data());
+                i = caps[1];
+
+            } else {
+                ++i;
+                break;
+            }
+        }
+    }
+}
+
 template <bool REGEX>
 struct Searcher;
 
 template <>
 struct Searcher<true> {
 
-    std::reference_wrapper<const std::regex> rx;
+    regex::Regex* rx;
 
-    Searcher(const std::string& p) : rx(std::cref(regex_cache(p))) {}
+    Searcher(const std::string& p) : rx(&regex_cache(p)) {}
 
     bool matches(const std::string& s) {
-        return std::regex_search(s, rx.get());
+        return rx->search(s.data(), s.data() + s.size());
     }
 
-    void matches(const std::string& s, std::vector<std::string>& v) {
+    void matches(const std::string& s, Fields& v) {
 
-        std::sregex_iterator iter(s.begin(), s.end(), rx);
-        std::sregex_iterator end;
+        static const std::string empty;
 
-        while (iter != end) {
+        size_t n = rx->nslots();
 
-            if (iter->size() == 1) {
+        regex_each(*rx, s, [&](const char** caps) {
 
-                v.emplace_back(iter->str());
+            for (size_t j = (n > 2 ? 2 : 0); j < n; j += 2) {
 
-            } else if (iter->size() > 1) {
-                auto subi = iter->begin();
-                auto sube = iter->end();
-                ++subi;
-            
-                while (subi != sube) {
-                    v.emplace_back(subi->str());
-                    ++subi;
+                if (caps[j]) {
+                    v.add(caps[j], caps[j + 1]);
+                } else {
+                    v.add(empty);
                 }
             }
-
-            ++iter;
-        }
+        });
     }
 };
 
@@ -267,10 +406,10 @@ struct Searcher<false> {
         return (::strstr(s.data(), substr.get().data()) != nullptr);
     }
 
-    void matches(const std::string& s, std::vector<std::string>& v) {
+    void matches(const std::string& s, Fields& v) {
 
         if (matches(s)) {
-            v.emplace_back(substr);
+            v.add(substr);
         }
     }
 };
@@ -284,13 +423,12 @@ void grep(const obj::Object* in, obj::Object*& out) {
     const std::string& pattern = obj::get<obj::String>(args.v[1]).v;
 
     obj::ArrayAtom<std::string>& vv = obj::get< obj::ArrayAtom<std::string> >(out);
-    std::vector<std::string>& v = vv.v;
-
-    v.clear();
+    Fields v(vv.v);
 
     Searcher<REGEX> searcher(pattern);
 
     searcher.matches(str, v);
+    v.finish();
 }
 
 template <bool REGEX>
@@ -390,6 +528,186 @@ Functions::func_t grepif_checker(const Type& args, Type& ret, obj::Object*& obj)
     return nullptr;
 }
 
+struct FindIfAny : public obj::UInt {
+    multifind::Matcher matcher;
+};
+
+// With FIXED, the patterns can't change between calls; see 'fixed_patterns()'
+// in optimize.h.
+template <bool FIXED>
+void findif_any(const obj::Object* in, obj::Object*& out) {
+
+    obj::Tuple& args = obj::get<obj::Tuple>(in);
+
+    const std::string& str = obj::get<obj::String>(args.v[0]).v;
+    const std::vector<std::string>& patts = obj::get< obj::ArrayAtom<std::string> >(args.v[1]).v;
+
+    FindIfAny& res = obj::get<FindIfAny>(out);
+
+    res.matcher.set(patts, FIXED);
+    res.v = (res.matcher.any(str.data(), str.data() + str.size()) ? 1 : 0);
+}
+
+struct SeqFindIfAny : public obj::SeqBase {
+
+    obj::Object* seq;
+    multifind::Matcher matcher;
+
+    obj::Object* next() {
+
+        while (1) {
+            obj::Object* ret = seq->next();
+
+            if (!ret)
+                return ret;
+
+            const std::string& str = obj::get<obj::String>(ret).v;
+
+            if (matcher.any(str.data(), str.data() + str.size()))
+                return ret;
+        }
+    }
+};
+
+void findif_any_seq(const obj::Object* in, obj::Object*& out) {
+
+    obj::Tuple& args = obj::get<obj::Tuple>(in);
+
+    SeqFindIfAny& sfind = obj::get<SeqFindIfAny>(out);
+
+    sfind.matcher.set(obj::get< obj::ArrayAtom<std::string> >(args.v[1]).v);
+    sfind.seq = args.v[0];
+}
+
+bool check_strings(const Type& t) {
+    return (t.type == Type::ARR && t.tuple && t.tuple->size() == 1 && check_string(t.tuple->at(0)));
+}
+
+Functions::func_t findif_checker(const Type& args, Type& ret, obj::Object*& obj) {
+
+    if (args.type != Type::TUP || !args.tuple || args.tuple->size() != 2)
+        return nullptr;
+
+    const Type& t1 = args.tuple->at(0);
+    const Type& t2 = args.tuple->at(1);
+
+    if (!check_strings(t2))
+        return grepif_checker<false>(args, ret, obj);
+
+    if (check_string(t1)) {
+
+        ret = Type(Type::UINT);
+        obj = new FindIfAny;
+        return findif_any<false>;
+    }
+
+    if (t1.type == Type::SEQ && t1.tuple && t1.tuple->size() == 1 && check_string(t1.tuple->at(0))) {
+
+        ret = Type(Type::SEQ);
+        ret.push(Type(Type::STRING));
+        obj = new SeqFindIfAny;
+        return findif_any_seq;
+    }
+
+    return nullptr;
+}
+
+struct FindAll : public obj::ArrayAtom<UInt> {
+    multifind::Matcher matcher;
+};
+
+template <bool FIXED>
+void findall(const obj::Object* in, obj::Object*& out) {
+
+    obj::Tuple& args = obj::get<obj::Tuple>(in);
+
+    const std::string& str = obj::get<obj::String>(args.v[0]).v;
+    const std::vector<std::string>& patts = obj::get< obj::ArrayAtom<std::string> >(args.v[1]).v;
+
+    FindAll& res = obj::get<FindAll>(out);
+
+    res.matcher.set(patts, FIXED);
+    res.matcher.all(str.data(), str.data() + str.size(), res.v);
+}
+
+Functions::func_t findall_checker(const Type& args, Type& ret, obj::Object*& obj) {
+
+    if (args.type != Type::TUP || !args.tuple || args.tuple->size() != 2)
+        return nullptr;
+
+    if (!check_string(args.tuple->at(0)) || !check_strings(args.tuple->at(1)))
+        return nullptr;
+
+    ret = Type(Type::ARR, { Type(Type::UINT) });
+    obj = new FindAll;
+    return findall<false>;
+}
+
+// Appends 'rep' with the '$' substitutions of 'std::regex_replace'.
+void replace_format(std::string& res, const std::string& rep, const char** caps, size_t nslots,
+                    const char* prefix, const char* e) {
+
+    const char* i = rep.data();
+    const char* end = i + rep.size();
+
+    auto group = [&](size_t n) {
+        if (n * 2 < nslots && caps[n * 2])
+            res.append(caps[n * 2], caps[n * 2 + 1]);
+    };
+
+    while (i != end) {
+
+        const char* d = (const char*)::memchr(i, '$', end - i);
+
+        if (!d) {
+            res.append(i, end);
+            break;
+        }
+
+        res.append(i, d);
+        i = d + 1;
+
+        if (i == end) {
+            res += '$';
+            break;
+        }
+
+        char c = *i;
+
+        if (c == '$') {
+            res += '$';
+            ++i;
+
+        } else if (c == '&') {
+            group(0);
+            ++i;
+
+        } else if (c == '`') {
+            res.append(prefix, caps[0]);
+            ++i;
+
+        } else if (c == '\'') {
+            res.append(caps[1], e);
+            ++i;
+
+        } else if (c >= '0' && c <= '9') {
+
+            size_t n = c - '0';
+            ++i;
+
+            if (i != end && *i >= '0' && *i <= '9') {
+                n = n * 10 + (*i - '0');
+                ++i;
+            }
+
+            group(n);
+
+        } else {
+            res += '$';
+        }
+    }
+}
+
 void replace(const obj::Object* in, obj::Object*& out) {
 
     obj::Tuple& args = obj::get<obj::Tuple>(in);
@@ -400,11 +718,21 @@ void replace(const obj::Object* in, obj::Object*& out) {
     
     std::string& res = obj::get<obj::String>(out).v;
 
-    const std::regex& r = regex_cache(regex);
+    regex::Regex& r = regex_cache(regex);
+
+    const char* prev = str.data();
+    const char* e = prev + str.size();
+    size_t nslots = r.nslots();
 
     res.clear();
 
-    std::regex_replace(std::back_insert_iterator<std::string>(res), str.begin(), str.end(), r, rep);
+    regex_each(r, str, [&](const char** caps) {
+        res.append(prev, caps[0]);
+        replace_format(res, rep, caps, nslots, prev, e);
+        prev = caps[1];
+    });
+
+    res.append(prev, e);
 }
 
 void recut(const obj::Object* in, obj::Object*& out) {
@@ -415,35 +743,39 @@ void recut(const obj::Object* in, obj::Object*& out) {
     const std::string& regex = obj::get<obj::String>(args.v[1]).v;
 
     obj::ArrayAtom<std::string>& vv = obj::get< obj::ArrayAtom<std::string> >(out);
-    std::vector<std::string>& v = vv.v;
+    Fields v(vv.v);
 
-    v.clear();
+    regex::Regex& r = regex_cache(regex);
 
-    const std::regex& r = regex_cache(regex);
+    const char* iter = str.data();
+    const char* end = iter + str.size();
+
+    std::vector<const char*>& caps = r.caps;
+    caps.resize(r.nslots());
 
-    auto iter = str.begin();
-    auto end = str.end();
-    std::smatch match;
-    
     while (1) {
 
-        if (!std::regex_search(iter, end, match, r)) {
-            v.emplace_back(iter, end);
+        // Like 'std::regex_search(iter, end)': the rest of the string is
+        // searched as if it started at 'iter'.
+        if (!r.find(iter, iter, end, caps.data())) {
+            v.add(iter, end);
             break;
         }
 
-        v.emplace_back(iter, match[0].first);
+        v.add(iter, caps[0]);
 
-        if (iter == match[0].second)
+        if (iter == caps[1])
             throw std::runtime_error("Cannot use an empty match as a delimiter in 'recut'.");
 
-        iter = match[0].second;
+        iter = caps[1];
 
         if (iter == end) {
-            v.emplace_back();
+            v.add(end, end);
             break;
         }
     }
+
+    v.finish();
 }
 
 void recutn(const obj::Object* in, obj::Object*& out) {
@@ -457,29 +789,31 @@ void recutn(const obj::Object* in, obj::Object*& out) {
     std::string& v = obj::get<obj::String>(out).v;
     v.clear();
 
-    const std::regex& r = regex_cache(regex);
+    regex::Regex& r = regex_cache(regex);
 
     UInt nmatch = 0;
 
-    auto iter = str.begin();
-    auto end = str.end();
-    std::smatch match;
-    
+    const char* iter = str.data();
+    const char* end = iter + str.size();
+
+    std::vector<const char*>& caps = r.caps;
+    caps.resize(r.nslots());
+
     while (iter != end) {
 
-        if (!std::regex_search(iter, end, match, r)) {
+        if (!r.find(iter, iter, end, caps.data())) {
             break;
         }
 
-        if (iter == match[0].second)
+        if (iter == caps[1])
             throw std::runtime_error("Cannot use an empty match as a delimiter in 'recut'.");
 
         if (nmatch == nth) {
-            v.assign(iter, match[0].first);
+            v.assign(iter, caps[0]);
             return;
         }
         
-        iter = match[0].second;
+        iter = caps[1];
         ++nmatch;
     }
 
@@ -488,7 +822,8 @@ void recutn(const obj::Object* in, obj::Object*& out) {
         return;
     }
 
-    throw std::runtime_error("Substring not found in 'recut'");
+    if (!soft_fail())
+        throw std::runtime_error("Substring not found in 'recut'");
 }
 
 void recut_seq(const obj::Object* in, obj::Object*& out) {
@@ -527,6 +862,22 @@ void register_cutgrep(Functions& funcs) {
     funcs.add_poly("cut", cut_checker);
     funcs.add_poly("split", cut_checker);
 
+    // Only produced by 'lazy_cut_index()' and 'lazy_cut_limit()' in optimize.h.
+    funcs.add("__cut_index",
+              Type(Type::TUP, { Type(Type::STRING), Type(Type::STRING), Type(Type::UINT) }),
+              Type(Type::STRING),
+              cutn<UInt, true>);
+
+    funcs.add("__cut_index",
+              Type(Type::TUP, { Type(Type::STRING), Type(Type::STRING), Type(Type::INT) }),
+              Type(Type::STRING),
+              cutn<Int, true>);
+
+    funcs.add("__cut_limit",
+              Type(Type::TUP, { Type(Type::STRING), Type(Type::STRING), Type(Type::UINT) }),
+              Type(Type::ARR, { Type::STRING }),
+              cut_limit);
+
     funcs.add("grep",
               Type(Type::TUP, { Type(Type::STRING), Type(Type::STRING) }),
               Type(Type::ARR, { Type::STRING }),
@@ -539,7 +890,19 @@ void register_cutgrep(Functions& funcs) {
               Type(Type::ARR, { Type::STRING }),
               grep<false>);
 
-    funcs.add_poly("findif", grepif_checker<false>);
+    funcs.add_poly("findif", findif_checker);
+    funcs.add_poly("findall", findall_checker);
+
+    // Only produced by 'fixed_patterns()' in optimize.h.
+    funcs.add("__findif_fixed",
+              Type(Type::TUP, { Type(Type::STRING), Type(Type::ARR, { Type::STRING }) }),
+              Type(Type::UINT),
+              findif_any<true>);
+
+    funcs.add("__findall_fixed",
+              Type(Type::TUP, { Type(Type::STRING), Type(Type::ARR, { Type::STRING }) }),
+              Type(Type::ARR, { Type::UINT }),
+              findall<true>);
 
     funcs.add("replace",
               Type(Type::TUP, { Type(Type::STRING), Type(Type::STRING), Type(Type::STRING) }),
@@ -55,13 +55,8 @@ struct SeqSkipSeq : public obj::SeqBase {
     
     obj::Object* next() {
 
-        while (i < n) {
-            obj::Object* ret = seq->next();
-
-            if (!ret) return ret;
-        
-            ++i;
-        }
+        if (i < n)
+            i += seq->skip(n - i);
 
         return seq->next();
     }
@@ -34,6 +34,8 @@ void hasfun_map(const obj::Object* in, obj::Object*& out) {
     obj::Object* key = args.v[1];
     obj::UInt& r = obj::get<obj::UInt>(out);
 
+    map.box();
+
     if (map.v.find(key) == map.v.end()) {
         r.v = 0;
     } else {
@@ -40,8 +40,10 @@ struct index_array {
 
         size_t ii = __array_ix_conform(a.v.size(), i.v);
 
-        if (ii >= a.v.size())
+        if (ii >= a.v.size()) {
+            if (soft_fail()) return;
             throw std::runtime_error("Array index out of bounds");
+        }
 
         RetT& ret = obj::get<RetT>(out);
         ret.v = a.v[ii];
@@ -59,8 +61,10 @@ struct index_array<Obj,obj::Object,IxT> {
 
         size_t ii = __array_ix_conform(a.v.size(), i.v);
 
-        if (ii >= a.v.size())
+        if (ii >= a.v.size()) {
+            if (soft_fail()) return;
             throw std::runtime_error("Array index out of bounds");
+        }
 
         out = a.v[ii];
     }
@@ -77,11 +81,15 @@ void slice_array(const obj::Object* in, obj::Object*& out) {
     size_t ii1 = __array_ix_conform(a.v.size(), i1.v);
     size_t ii2 = __array_ix_conform(a.v.size(), i2.v);
 
-    if (ii1 >= a.v.size() || ii2 >= a.v.size())
+    if (ii1 >= a.v.size() || ii2 >= a.v.size()) {
+        if (soft_fail()) return;
         throw std::runtime_error("Array index out of bounds");
+    }
 
-    if (ii2 < ii1)
+    if (ii2 < ii1) {
+        if (soft_fail()) return;
         throw std::runtime_error("Array slice indexes are not in order");
+    }
     
     Obj& ret = obj::get<Obj>(out);
     ret.v.clear();
@@ -145,10 +153,14 @@ void map_index_one(const obj::Object* in, obj::Object*& out) {
     obj::MapObject<SORTED>& map = obj::get< obj::MapObject<SORTED> >(args.v[0]);
     obj::Object* key = args.v[1];
 
+    map.box();
+
     auto i = map.v.find(key);
 
-    if (i == map.v.end())
+    if (i == map.v.end()) {
+        if (soft_fail()) return;
         throw std::runtime_error("Key is not in map");
+    }
 
     out = i->second;
 }
@@ -164,8 +176,10 @@ void map_index_tup(const obj::Object* in, obj::Object*& out) {
 
     auto i = map.v.find(key);
 
-    if (i == map.v.end())
+    if (i == map.v.end()) {
+        if (soft_fail()) return;
         throw std::runtime_error("Key is not in map");
+    }
 
     out = i->second;
 }
@@ -191,13 +205,17 @@ void index_substr(const obj::Object* in, obj::Object*& out) {
     size_t i1 = __array_ix_conform(v.size(), a1);
     size_t i2 = __array_ix_conform(v.size(), a2);
 
-    if (i1 >= v.size() || i2 >= v.size())
+    if (i1 >= v.size() || i2 >= v.size()) {
+        if (soft_fail()) return;
         throw std::runtime_error("Substring index out of bounds");
+    }
 
-    if (i2 < i1)
+    if (i2 < i1) {
+        if (soft_fail()) return;
         throw std::runtime_error("Substring indexes are not in order");
+    }
 
-    o = v.substr(i1, i2-i1+1);
+    o.assign(v, i1, i2-i1+1);
 }
 
 template <bool SORTED>
@@ -313,6 +331,8 @@ void map_get(const obj::Object* in, obj::Object*& out) {
     obj::Object* key = args.v[1];
     obj::Object* val = args.v[2];
 
+    map.box();
+
     auto i = map.v.find(key);
 
     if (i == map.v.end()) {
@@ -6,6 +6,7 @@ void map_from_tuple(const obj::Object* in, obj::Object*& out) {
     obj::MapObject<SORTED>& o = obj::get< obj::MapObject<SORTED> >(out);
     obj::Tuple& i = obj::get<obj::Tuple>(in);
 
+    o.box();
     o.v.clear();
     o.v[i.v[0]] = i.v[1];
 }
@@ -89,6 +90,7 @@ struct FlipSeqMapObject : public obj::SeqBase {
     
     void wrap(Object* a) {
         obj::MapObject<SORTED>* map = (obj::MapObject<SORTED>*)a;
+        map->box();
         b = map->v.begin();
         e = map->v.end();
     }
@@ -180,6 +182,7 @@ struct NthSeqMapObject : public obj::SeqBase {
     
     void wrap(Object* a) {
         obj::MapObject<SORTED>* map = (obj::MapObject<SORTED>*)a;
+        map->box();
         b = map->v.begin();
         e = map->v.end();
     }
@@ -6,62 +6,85 @@ void x_to_y(const obj::Object* in, obj::Object*& out) {
     obj::get<Y>(out).v = obj::get<X>(in).v;
 }
 
+bool parse_real(const std::string& s, Real& out) {
+    return number::parse_real(s.data(), s.data() + s.size(), out);
+}
+
+bool parse_int(const std::string& s, Int& out) {
+    return number::parse_int(s.data(), s.data() + s.size(), out);
+}
+
+bool parse_uint(const std::string& s, UInt& out) {
+    return number::parse_uint(s.data(), s.data() + s.size(), out);
+}
+
 void string_to_real(const obj::Object* in, obj::Object*& out) {
-    try {
-        obj::get<obj::Real>(out).v = std::stod(obj::get<obj::String>(in).v);
-    } catch (std::exception& e) {
-        throw std::runtime_error("Could not convert '" + obj::get<obj::String>(in).v + "' to a floating-point number.");
-    }
+    const std::string& s = obj::get<obj::String>(in).v;
+
+    if (!parse_real(s, obj::get<obj::Real>(out).v) && !soft_fail())
+        throw std::runtime_error("Could not convert '" + s + "' to a floating-point number.");
 }
 
 void string_to_int(const obj::Object* in, obj::Object*& out) {
-    try {
-        obj::get<obj::Int>(out).v = std::stol(obj::get<obj::String>(in).v, 0, 0);
-    } catch (std::exception& e) {
-        throw std::runtime_error("Could not convert '" + obj::get<obj::String>(in).v + "' to an integer.");
-    }
+    const std::string& s = obj::get<obj::String>(in).v;
+
+    if (!parse_int(s, obj::get<obj::Int>(out).v) && !soft_fail())
+        throw std::runtime_error("Could not convert '" + s + "' to an integer.");
 }
 
 void string_to_uint(const obj::Object* in, obj::Object*& out) {
-    try {
-        obj::get<obj::UInt>(out).v = std::stoul(obj::get<obj::String>(in).v, 0, 0);
-    } catch (std::exception& e) {
-        throw std::runtime_error("Could not convert '" + obj::get<obj::String>(in).v + "' to an unsigned integer.");
-    }
+    const std::string& s = obj::get<obj::String>(in).v;
+
+    if (!parse_uint(s, obj::get<obj::UInt>(out).v) && !soft_fail())
+        throw std::runtime_error("Could not convert '" + s + "' to an unsigned integer.");
 }
 
 void string_to_real_def(const obj::Object* in, obj::Object*& out) {
     obj::Tuple& arg = obj::get<obj::Tuple>(in);
-    try {
-        obj::get<obj::Real>(out).v = std::stod(obj::get<obj::String>(arg.v[0]).v);
-    } catch (std::exception& e) {
+
+    if (!parse_real(obj::get<obj::String>(arg.v[0]).v, obj::get<obj::Real>(out).v))
         obj::get<obj::Real>(out).v = obj::get<obj::Real>(arg.v[1]).v;
-    }
 }
 
 template <typename T>
 void string_to_int_def(const obj::Object* in, obj::Object*& out) {
     obj::Tuple& arg = obj::get<obj::Tuple>(in);
-    try {
-        obj::get<obj::Int>(out).v = std::stol(obj::get<obj::String>(arg.v[0]).v, 0, 0);
-    } catch (std::exception& e) {
+
+    if (!parse_int(obj::get<obj::String>(arg.v[0]).v, obj::get<obj::Int>(out).v))
         obj::get<obj::Int>(out).v = obj::get<T>(arg.v[1]).v;
-    }
 }
 
 template <typename T>
 void string_to_uint_def(const obj::Object* in, obj::Object*& out) {
     obj::Tuple& arg = obj::get<obj::Tuple>(in);
-    try {
-        obj::get<obj::UInt>(out).v = std::stoul(obj::get<obj::String>(arg.v[0]).v, 0, 0);
-    } catch (std::exception& e) {
+
+    if (!parse_uint(obj::get<obj::String>(arg.v[0]).v, obj::get<obj::UInt>(out).v))
         obj::get<obj::UInt>(out).v = obj::get<T>(arg.v[1]).v;
-    }
 }
 
-template <typename T>
-void to_string(const obj::Object* in, obj::Object*& out) {
-    obj::get<obj::String>(out).v = std::to_string(obj::get<T>(in).v);
+void int_to_string(const obj::Object* in, obj::Object*& out) {
+    char tmp[number::FORMAT_SPACE];
+    obj::get<obj::String>(out).v.assign(tmp, number::format_int(obj::get<obj::Int>(in).v, tmp));
+}
+
+void uint_to_string(const obj::Object* in, obj::Object*& out) {
+    char tmp[number::FORMAT_SPACE];
+    obj::get<obj::String>(out).v.assign(tmp, number::format_uint(obj::get<obj::UInt>(in).v, tmp));
+}
+
+// Like '%f', unless '-R' asks for reals that read back exactly.
+void real_to_string(const obj::Object* in, obj::Object*& out) {
+
+    Real v = obj::get<obj::Real>(in).v;
+    std::string& res = obj::get<obj::String>(out).v;
+
+    if (!obj::print_roundtrip_reals()) {
+        res = std::to_string(v);
+        return;
+    }
+
+    char tmp[number::FORMAT_SPACE];
+    res.assign(tmp, number::format_real(v, tmp, true));
 }
 
 void pi(const obj::Object* in, obj::Object*& out) {
@@ -155,9 +178,9 @@ void register_math(Functions& funcs) {
     funcs.add("uint", Type(Type::TUP, { Type(Type::STRING), Type(Type::UINT) }), Type(Type::UINT),
               string_to_uint_def<obj::UInt>);
 
-    funcs.add("string", Type(Type::INT), Type(Type::STRING), to_string<obj::Int>);
-    funcs.add("string", Type(Type::UINT), Type(Type::STRING), to_string<obj::UInt>);
-    funcs.add("string", Type(Type::REAL), Type(Type::STRING), to_string<obj::Real>);
+    funcs.add("string", Type(Type::INT), Type(Type::STRING), int_to_string);
+    funcs.add("string", Type(Type::UINT), Type(Type::STRING), uint_to_string);
+    funcs.add("string", Type(Type::REAL), Type(Type::STRING), real_to_string);
 
     funcs.add("pi", Type(), Type(Type::REAL), pi);
     funcs.add("e", Type(), Type(Type::REAL), e);
@@ -18,6 +18,10 @@ struct AtomMinMax : public obj::Atom<T> {
             this->v = tmp;
         }
     }
+
+    obj::merge_t merge_kind() const {
+        return (typeid(*this) == typeid(AtomMinMax<MIN,T>) ? (MIN ? obj::MERGE_MIN : obj::MERGE_MAX) : obj::MERGE_OTHER);
+    }
 };
 
 template <typename T>
@@ -171,7 +171,7 @@ void bytes_to_string(const obj::Object* in, obj::Object*& out) {
 }
 
 void obj_hash(const obj::Object* in, obj::Object*& out) {
-    obj::get<obj::UInt>(out).v = in->hash();
+    obj::get<obj::UInt>(out).v = in->fnv_hash();
 }
 
 Functions::func_t hash_checker(const Type& args, Type& ret, obj::Object*& obj) {
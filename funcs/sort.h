@@ -107,6 +107,279 @@ void sort_seq_arr(const obj::Object* in, obj::Object*& out) {
     std::sort(x.v.begin(), x.v.end());
 }
 
+// Sorting sequences that don't fit in memory: 'sort(seq, budget)' sorts
+// runs of up to 'budget' bytes in memory and writes them out to temporary
+// files, then merges the runs as the resulting sequence is read. Runs are
+// merged on disk SORT_FANIN at a time, in levels, so that the number of
+// open files stays small and every element is rewritten only a few times.
+
+static const size_t SORT_FANIN = 64;
+
+FILE* sort_tmpfile() {
+
+    const char* dir = ::getenv("TMPDIR");
+    std::string name = std::string(dir && *dir ? dir : "/tmp") + "/tab-sort-XXXXXX";
+
+    int fd = ::mkstemp(&name[0]);
+
+    if (fd < 0)
+        throw std::runtime_error("Could not create a temporary file for 'sort': " + name);
+
+    ::unlink(name.c_str());
+
+    FILE* ret = ::fdopen(fd, "w+b");
+
+    if (!ret) {
+        ::close(fd);
+        throw std::runtime_error("Could not create a temporary file for 'sort': " + name);
+    }
+
+    ::setvbuf(ret, nullptr, _IOFBF, 256*1024);
+    return ret;
+}
+
+template <typename T>
+void sort_write(FILE* f, const T& v) {
+    ::fwrite(&v, sizeof(T), 1, f);
+}
+
+void sort_write(FILE* f, const std::string& v) {
+
+    uint64_t n = v.size();
+
+    ::fwrite(&n, sizeof(n), 1, f);
+    ::fwrite(v.data(), 1, n, f);
+}
+
+template <typename T>
+bool sort_read(FILE* f, T& v) {
+    return (::fread(&v, sizeof(T), 1, f) == 1);
+}
+
+bool sort_read(FILE* f, std::string& v) {
+
+    uint64_t n;
+
+    if (::fread(&n, sizeof(n), 1, f) != 1)
+        return false;
+
+    v.resize(n);
+
+    return (n == 0 || ::fread(&v[0], 1, n, f) == n);
+}
+
+template <typename T>
+size_t sort_size(const T& v) {
+    return sizeof(T);
+}
+
+size_t sort_size(const std::string& v) {
+    return sizeof(std::string) + v.size();
+}
+
+template <typename T>
+struct SeqSortExternal : public obj::SeqBase {
+
+    obj::Atom<T>* holder;
+
+    // The runs on disk, and then the one in memory.
+    std::vector<FILE*> runs;
+    std::vector<size_t> levels;
+    std::vector<T> buffer;
+    size_t buffer_i;
+    size_t bytes;
+
+    std::vector<T> heads;
+    std::vector<size_t> heap;
+
+    SeqSortExternal() : buffer_i(0), bytes(0) {
+        holder = new obj::Atom<T>;
+    }
+
+    ~SeqSortExternal() {
+        clear();
+        delete holder;
+    }
+
+    void clear() {
+
+        for (FILE* f : runs) {
+            ::fclose(f);
+        }
+
+        runs.clear();
+        levels.clear();
+        buffer.clear();
+        buffer_i = 0;
+        bytes = 0;
+        heap.clear();
+    }
+
+    void add(const T& v, UInt budget) {
+
+        buffer.push_back(v);
+        bytes += sort_size(v);
+
+        if (bytes > budget)
+            spill();
+    }
+
+    void finish_run(FILE* f) {
+
+        if (::fflush(f) != 0 || ::ferror(f))
+            throw std::runtime_error("Could not write a temporary file for 'sort'.");
+
+        ::rewind(f);
+    }
+
+    void spill() {
+
+        std::sort(buffer.begin(), buffer.end());
+
+        FILE* f = sort_tmpfile();
+
+        for (const T& v : buffer) {
+            sort_write(f, v);
+        }
+
+        finish_run(f);
+        runs.push_back(f);
+        levels.push_back(0);
+
+        buffer.clear();
+        bytes = 0;
+
+        while (runs.size() >= SORT_FANIN) {
+
+            size_t from = runs.size() - SORT_FANIN;
+            size_t level = levels.back();
+
+            if (levels[from] != level)
+                break;
+
+            FILE* merged = sort_tmpfile();
+            T v;
+
+            start(from);
+
+            while (pop(v)) {
+                sort_write(merged, v);
+            }
+
+            finish_run(merged);
+
+            for (size_t i = from; i < runs.size(); ++i) {
+                ::fclose(runs[i]);
+            }
+
+            runs.resize(from);
+            levels.resize(from);
+
+            runs.push_back(merged);
+            levels.push_back(level + 1);
+        }
+    }
+
+    bool pull(size_t i, T& v) {
+
+        if (i < runs.size()) {
+
+            if (sort_read(runs[i], v))
+                return true;
+
+            if (::ferror(runs[i]))
+                throw std::runtime_error("Could not read a temporary file for 'sort'.");
+
+            return false;
+        }
+
+        if (buffer_i < buffer.size()) {
+            std::swap(v, buffer[buffer_i]);
+            ++buffer_i;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool greater(size_t a, size_t b) const {
+        return heads[b] < heads[a];
+    }
+
+    // Merges the runs from 'from' onwards and the one in memory.
+    void start(size_t from = 0) {
+
+        if (buffer_i == 0)
+            std::sort(buffer.begin(), buffer.end());
+
+        heads.resize(runs.size() + 1);
+        heap.clear();
+
+        auto cmp = [this](size_t a, size_t b) { return greater(a, b); };
+
+        for (size_t i = from; i < heads.size(); ++i) {
+
+            if (pull(i, heads[i])) {
+                heap.push_back(i);
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+
+    bool pop(T& v) {
+
+        if (heap.empty())
+            return false;
+
+        auto cmp = [this](size_t a, size_t b) { return greater(a, b); };
+
+        std::pop_heap(heap.begin(), heap.end(), cmp);
+
+        size_t i = heap.back();
+
+        std::swap(v, heads[i]);
+
+        if (pull(i, heads[i])) {
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        } else {
+            heap.pop_back();
+        }
+
+        return true;
+    }
+
+    obj::Object* next() {
+
+        if (!pop(holder->v))
+            return nullptr;
+
+        return holder;
+    }
+};
+
+template <typename T>
+void sort_seq_external(const obj::Object* in, obj::Object*& out) {
+
+    obj::Tuple& args = obj::get<obj::Tuple>(in);
+    obj::Object* seq = args.v[0];
+    UInt budget = obj::get<obj::UInt>(args.v[1]).v;
+
+    SeqSortExternal<T>& s = obj::get< SeqSortExternal<T> >(out);
+
+    s.clear();
+
+    while (1) {
+        obj::Object* x = seq->next();
+
+        if (!x)
+            break;
+
+        s.add(obj::get< obj::Atom<T> >(x).v, budget);
+    }
+
+    s.start();
+}
+
 template <bool SORTED>    
 Functions::func_t sort_checker(const Type& args, Type& ret, obj::Object*& obj) {
 
@@ -208,6 +481,33 @@ Functions::func_t sort_checker(const Type& args, Type& ret, obj::Object*& obj) {
 
         return nullptr;
 
+    } else if (args.type == Type::TUP && args.tuple->size() == 2 &&
+               args.tuple->at(0).type == Type::SEQ && check_unsigned(args.tuple->at(1))) {
+
+        const Type& t = args.tuple->at(0).tuple->at(0);
+
+        if (t.type != Type::ATOM)
+            return nullptr;
+
+        ret = args.tuple->at(0);
+
+        switch (t.atom) {
+        case Type::INT:
+            obj = new SeqSortExternal<Int>;
+            return sort_seq_external<Int>;
+        case Type::UINT:
+            obj = new SeqSortExternal<UInt>;
+            return sort_seq_external<UInt>;
+        case Type::REAL:
+            obj = new SeqSortExternal<Real>;
+            return sort_seq_external<Real>;
+        case Type::STRING:
+            obj = new SeqSortExternal<std::string>;
+            return sort_seq_external<std::string>;
+        }
+
+        return nullptr;
+
     } else if (args.type == Type::TUP) {
 
         Type first = *(args.tuple->begin());
@@ -17,6 +17,10 @@ struct AtomSumMul : public obj::Atom<T> {
 	    this->v += obj::get< obj::Atom<T> >(o).v;
 	}
     }
+
+    obj::merge_t merge_kind() const {
+        return (typeid(*this) == typeid(AtomSumMul<MUL, T>) ? (MUL ? obj::MERGE_MUL : obj::MERGE_ADD) : obj::MERGE_OTHER);
+    }
 };
 
 template <typename T>
@@ -33,65 +33,189 @@ struct AtomUniques : public obj::UInt {
 
 
 // Count unique elements using the HyperLogLog statistical estimator.
-// Introduces an error but uses a constant amount of memory.
-// Not very good for counting small sets of values!
+// Introduces an error but uses a constant amount of memory: 2^p bytes,
+// where the precision p is 12 by default. The registers are indexed and
+// ranked from all the bits of 'hash_t', which is 32 bits wide on 32-bit
+// builds.
+//
+// Small sets are kept as a sorted list of hashes (with a count that is
+// exact) until the list would take as much memory as the registers.
+// The dense estimate uses Ertl's improved estimator, which needs no
+// empirical bias correction for small or mid-range counts.
+// (O. Ertl, "New cardinality estimation algorithms for HyperLogLog sketches", 2017.)
 
-template <size_t NumBucketBits = 12>
 struct AtomUniquesEstimate : public obj::UInt {
 
-    std::unordered_map<UInt,uint8_t> bits;
+    static const uint8_t DEFAULT_PRECISION = 12;
+    static const uint8_t MIN_PRECISION = 4;
+    static const uint8_t MAX_PRECISION = 18;
 
-    AtomUniquesEstimate() : obj::UInt(0), bits() {}
+    static const size_t BITS = sizeof(hash_t) * 8;
+
+    uint8_t p;
+    std::vector<hash_t> sparse;
+    std::vector<uint8_t> regs;
+
+    AtomUniquesEstimate(uint8_t _p = DEFAULT_PRECISION) : obj::UInt(0), p(_p) {}
 
     obj::Object* clone() const {
-        AtomUniquesEstimate<NumBucketBits>* ret = new AtomUniquesEstimate<NumBucketBits>;
+        AtomUniquesEstimate* ret = new AtomUniquesEstimate(p);
         ret->v = v;
-        ret->bits = bits;
+        ret->sparse = sparse;
+        ret->regs = regs;
         return ret;
     }
 
-    uint8_t count_trailing_zeros(UInt n) {
-        uint8_t ret = 1;
-        size_t mask = 1;
+    size_t sparse_limit() const {
+        return ((size_t)1 << p) / sizeof(hash_t);
+    }
+
+    void add_dense(hash_t h) {
+        size_t i = h >> (BITS - p);
+        uint8_t rank = __builtin_clzl((h << p) | ((hash_t)1 << (p - 1))) + 1;
 
-        while (ret < 255) {
-            if (mask & n)
-                break;
+        if (rank > regs[i])
+            regs[i] = rank;
+    }
+
+    void to_dense() {
+        regs.assign((size_t)1 << p, 0);
 
-            ret++;
-            mask <<= 1;
+        for (hash_t h : sparse) {
+            add_dense(h);
         }
 
-        return ret;
+        sparse.clear();
+        sparse.shrink_to_fit();
     }
 
-    void insert(const obj::Object* o) {
-        v = 1;
-        bits.clear();
+    void add(hash_t h) {
+
+        if (!regs.empty()) {
+            add_dense(h);
+            return;
+        }
+
+        auto i = std::lower_bound(sparse.begin(), sparse.end(), h);
+
+        if (i != sparse.end() && *i == h)
+            return;
+
+        sparse.insert(i, h);
+
+        if (sparse.size() > sparse_limit())
+            to_dense();
+    }
 
-        const UInt h = o->hash();
-        const UInt h0 = h & ((1 << NumBucketBits) - 1);
-        const UInt h1 = h >> NumBucketBits;
+    void merge_regs(const std::vector<uint8_t>& other) {
 
-        bits[h0] = count_trailing_zeros(h1);
+        uint8_t* a = regs.data();
+        const uint8_t* b = other.data();
+        size_t n = regs.size();
+        size_t i = 0;
+
+#if defined(__SSE2__)
+        for (; i + 16 <= n; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(a + i), _mm_max_epu8(x, y));
+        }
+#endif
+        for (; i < n; ++i) {
+            a[i] = std::max(a[i], b[i]);
+        }
+    }
+
+    void insert(const obj::Object* o) {
+        v = 1;
+        regs.clear();
+        sparse.assign(1, o->hash());
     }
 
     void merge(const obj::Object* o) {
-        AtomUniquesEstimate<NumBucketBits>& x = obj::get< AtomUniquesEstimate<NumBucketBits> >(o);
+        const AtomUniquesEstimate& x = obj::get<AtomUniquesEstimate>(o);
 
-        for (const auto& i : x.bits) {
-            bits[i.first] = std::max(bits[i.first], i.second);
+        if (x.p != p)
+            throw std::runtime_error("uniques_estimate: cannot merge estimates with different precision.");
+
+        if (x.regs.empty()) {
+
+            for (hash_t h : x.sparse) {
+                add(h);
+            }
+
+            return;
         }
+
+        if (regs.empty())
+            to_dense();
+
+        merge_regs(x.regs);
+    }
+
+    static Real sigma(Real x) {
+
+        if (x == 1)
+            return std::numeric_limits<Real>::infinity();
+
+        Real y = 1;
+        Real z = x;
+        Real zp;
+
+        do {
+            x *= x;
+            zp = z;
+            z += x * y;
+            y += y;
+        } while (z != zp);
+
+        return z;
+    }
+
+    static Real tau(Real x) {
+
+        if (x == 0 || x == 1)
+            return 0;
+
+        Real y = 1;
+        Real z = 1 - x;
+        Real zp;
+
+        do {
+            x = ::sqrt(x);
+            zp = z;
+            y *= 0.5;
+            z -= (1 - x) * (1 - x) * y;
+        } while (z != zp);
+
+        return z / 3;
     }
 
     void merge_end() {
 
-        Real x = 0;
-        for (const auto& i : bits) {
-            x += i.second;
+        if (regs.empty()) {
+            v = sparse.size();
+            return;
+        }
+
+        size_t q = BITS - p;
+        Real m = regs.size();
+
+        std::vector<size_t> hist(q + 2, 0);
+
+        for (uint8_t r : regs) {
+            hist[r]++;
+        }
+
+        Real z = m * tau(1 - hist[q + 1] / m);
+
+        for (size_t k = q; k >= 1; --k) {
+            z = 0.5 * (z + hist[k]);
         }
 
-        v = ::round(0.39701 * bits.size() * pow(2, x / bits.size()));
+        z += m * sigma(hist[0] / m);
+
+        v = ::round((m / (2 * ::log(2))) * (m / z));
     }
 };
 
@@ -101,6 +225,10 @@ void uniques(const obj::Object* in, obj::Object*& out) {
     obj::get<T>(out).insert(in);
 }
 
+void uniques_estimate_prec(const obj::Object* in, obj::Object*& out) {
+    obj::get<AtomUniquesEstimate>(out).insert(obj::get<obj::Tuple>(in).v[0]);
+}
+
 template <typename T>
 Functions::func_t uniques_checker(const Type& args, Type& ret, obj::Object*& obj) {
 
@@ -113,10 +241,38 @@ Functions::func_t uniques_checker(const Type& args, Type& ret, obj::Object*& obj
     return uniques<T>;
 }
 
+// The precision sizes the registers when the aggregator is created, so it
+// has to be a literal.
+Functions::func_t uniques_estimate_prec_checker(const Type& args, Type& ret, obj::Object*& obj) {
+
+    if (args.type != Type::TUP || args.tuple->size() != 2)
+        return nullptr;
+
+    const Type& a = args.tuple->at(0);
+    const Type& prec = args.tuple->at(1);
+
+    if (a.type == Type::SEQ || !check_integer(prec))
+        return nullptr;
+
+    if (!prec.literal)
+        throw std::runtime_error("uniques_estimate_prec: the precision must be an integer literal.");
+
+    Int n = (prec.literal->which == Atom::INT ? prec.literal->inte : (Int)prec.literal->uint);
+
+    if (n < AtomUniquesEstimate::MIN_PRECISION || n > AtomUniquesEstimate::MAX_PRECISION)
+        throw std::runtime_error("uniques_estimate_prec: precision must be between 4 and 18.");
+
+    ret = Type(Type::UINT);
+    obj = new AtomUniquesEstimate(n);
+
+    return uniques_estimate_prec;
+}
+
 void register_uniques(Functions& funcs) {
 
     funcs.add_poly("uniques", uniques_checker<AtomUniques>);
-    funcs.add_poly("uniques_estimate", uniques_checker< AtomUniquesEstimate<> >);
+    funcs.add_poly("uniques_estimate", uniques_checker<AtomUniquesEstimate>);
+    funcs.add_poly("uniques_estimate_prec", uniques_estimate_prec_checker);
 }
 
 
@@ -37,6 +37,145 @@ hash_t do_hash<std::string>(const std::string& v, hash_t basis) {
     return do_hash(reinterpret_cast<const unsigned char*>(v.data()), v.size(), basis, fnv_prime());
 }
 
+// The hash used for map keys, uniques and everything else internal.
+// FNV above is kept for the 'hash' builtin, whose output is user-visible.
+//
+// This is wyhash: it reads 8 or 16 bytes at a time and mixes them with
+// a 64x64->128 bit multiply.
+
+#if defined(__SIZEOF_INT128__)
+
+namespace wy {
+
+const uint64_t s0 = 0xa0761d6478bd642fULL;
+const uint64_t s1 = 0xe7037ed1a0b428dbULL;
+const uint64_t s2 = 0x8ebc6af09c88c6e3ULL;
+const uint64_t s3 = 0x589965cc75374cc3ULL;
+
+inline void mum(uint64_t& a, uint64_t& b) {
+    __uint128_t r = a;
+    r *= b;
+    a = (uint64_t)r;
+    b = (uint64_t)(r >> 64);
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t r8(const unsigned char* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+inline uint64_t r4(const unsigned char* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+inline uint64_t r3(const unsigned char* p, size_t k) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+}
+
+inline hash_t fast_hash(const unsigned char* p, size_t n, uint64_t seed) {
+
+    using namespace wy;
+
+    seed ^= mix(seed ^ s0, s1);
+
+    uint64_t a;
+    uint64_t b;
+
+    if (n <= 16) {
+
+        if (n >= 4) {
+            a = (r4(p) << 32) | r4(p + ((n >> 3) << 2));
+            b = (r4(p + n - 4) << 32) | r4(p + n - 4 - ((n >> 3) << 2));
+
+        } else if (n > 0) {
+            a = r3(p, n);
+            b = 0;
+
+        } else {
+            a = b = 0;
+        }
+
+    } else {
+
+        size_t i = n;
+
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+
+            do {
+                seed = mix(r8(p) ^ s1, r8(p + 8) ^ seed);
+                see1 = mix(r8(p + 16) ^ s2, r8(p + 24) ^ see1);
+                see2 = mix(r8(p + 32) ^ s3, r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = mix(r8(p) ^ s1, r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = r8(p + i - 16);
+        b = r8(p + i - 8);
+    }
+
+    a ^= s1;
+    b ^= seed;
+    mum(a, b);
+
+    return (hash_t)mix(a ^ s0 ^ n, b ^ s1);
+}
+
+// Scalars and combined hashes go through a full avalanche (the murmur3
+// finalizer); a single multiply leaves the top bits of consecutive
+// integers too correlated for HyperLogLog bucketing.
+inline hash_t fast_hash_combine(hash_t h, hash_t seed) {
+    uint64_t x = (uint64_t)h ^ wy::mix((uint64_t)seed ^ wy::s0, wy::s1);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (hash_t)x;
+}
+
+#else
+
+inline hash_t fast_hash(const unsigned char* p, size_t n, hash_t seed) {
+    return do_hash(p, n, seed ^ fnv_basis(), fnv_prime());
+}
+
+inline hash_t fast_hash_combine(hash_t h, hash_t seed) {
+    return do_hash(h, seed ^ fnv_basis());
+}
+
+#endif
+
+template <typename T>
+hash_t fast_hash(const T& v) {
+    static_assert(sizeof(T) <= 8, "fast_hash() of a non-scalar type");
+    uint64_t x = 0;
+    memcpy(&x, &v, sizeof(v));
+
+    // A 32-bit 'hash_t' would otherwise drop the high half, which is all
+    // there is to an integer-valued double.
+    if (sizeof(hash_t) < sizeof(x))
+        x ^= x >> 32;
+
+    return fast_hash_combine((hash_t)x, 0);
+}
+
+template <>
+hash_t fast_hash<std::string>(const std::string& v) {
+    return fast_hash(reinterpret_cast<const unsigned char*>(v.data()), v.size(), 0);
+}
+
 }
 
 #endif
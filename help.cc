@@ -36,6 +36,11 @@ static const char* _help[][2] = {
       "Maps, by default, store values in an unspecified order. Use the '-s'\n"
       "command-line parameter to force a strict ordering on map keys.\n"
       "\n"
+      "Real numbers are printed with six significant digits, like printf's\n"
+      "'%g'. Use the '-R' command-line parameter to print them with as many\n"
+      "digits as it takes to read back exactly the same number; this also\n"
+      "applies to 'string()' of a real number.\n"
+      "\n"
       "The default number type in 'tab' is the unsigned integer. A plain\n"
       "sequence of digits will be interpreted as a UInt.\n"
       "\n"
@@ -151,12 +156,13 @@ static const char* _help[][2] = {
 
     { "functions",
       "\nabs add and array avg box bytes case cat ceil combo cos count cut date datetime\n"
-      "e eq exp explode file filter find findif first flatten flip floor get glue gmtime\n"
-      "grep grepif has hash head hex hist if iarray index int join lines log lsh map\n"
-      "max mean merge min mul ngrams normal now open or pairs peek pi product rand real\n"
-      "recut replace resplit reverse round rsh sample second seq sin skip sort sorted\n"
-      "split sqrt stddev stdev string sum take tan tabulate time tolower toupper triplets\n"
-      "tuple uint unflatten uniques uniques_estimate until url_getparam var variance while zip\n"
+      "e eq exp explode file filter find findall findif first flatten flip floor get glue\n"
+      "gmtime grep grepif has hash head hex hist if iarray index int join lines log lsh\n"
+      "map max mean merge min mul ngrams normal now open or pairs peek pi product rand\n"
+      "real recut replace resplit reverse round rsh sample second seq sin skip sort\n"
+      "sorted split sqrt stddev stdev string sum take tan tabulate time tolower toupper\n"
+      "triplets tuple uint unflatten uniques uniques_estimate uniques_estimate_prec until\n"
+      "url_getparam var variance while zip\n"
     },
 
     {"abs",
@@ -417,7 +423,7 @@ static const char* _help[][2] = {
     {"findif",
      "\n"
      "Filter strings that contain a substring.\n"
-     "See also: 'grep', 'grepif', 'find'.\n"
+     "See also: 'grep', 'grepif', 'find', 'findall'.\n"
      "\n"
      "Usage:\n"
      "\n"
@@ -429,6 +435,27 @@ static const char* _help[][2] = {
      "findif Seq[String], String -> Seq[String]\n"
      "    returns a sequence of only those strings that have a substring match.\n"
      "    Equivalent to ?[ findif(@,b), @ : a ].\n"
+     "\n"
+     "findif String, Arr[String] -> UInt\n"
+     "    returns 1 if the first argument contains any of the strings in the\n"
+     "    array as a substring, 0 otherwise. All of the substrings are looked\n"
+     "    for in one pass, so this is fast even for thousands of them; use\n"
+     "    array.file(...) to read them from a file.\n"
+     "\n"
+     "findif Seq[String], Arr[String] -> Seq[String]\n"
+     "    returns a sequence of only those strings that contain any of the\n"
+     "    substrings.\n"
+    },
+    {"findall",
+     "\n"
+     "Finds which of several substrings occur in a string.\n"
+     "See also: 'findif', 'find'.\n"
+     "\n"
+     "Usage:\n"
+     "\n"
+     "findall String, Arr[String] -> Arr[UInt]\n"
+     "    returns the indexes (starting from 0) of the substrings from the\n"
+     "    array that occur in the first argument, in increasing order.\n"
     },
     {"first",
      "\n"
@@ -558,7 +585,8 @@ static const char* _help[][2] = {
     {"hash",
      "\n"
      "Hashes a value to an unsigned integer. The FNV hash function (32 or\n"
-     "64 bit depending on CPU architecture) is used.\n"
+     "64 bit depending on CPU architecture) is used. Equal maps hash the\n"
+     "same whatever order their keys are stored in.\n"
      "\n"
      "Usage:\n"
      "\n"
@@ -1043,6 +1071,13 @@ static const char* _help[][2] = {
      "\n"
      "sort Seq[a] -> Arr[a]\n"
      "\n"
+     "sort Seq[a], UInt -> Seq[a]\n"
+     "    sorts a sequence of numbers or strings using at most about as many\n"
+     "    bytes of memory as the second argument; the rest is sorted in\n"
+     "    temporary files (in $TMPDIR, or /tmp) and merged as the result is\n"
+     "    read. Use this for inputs that don't fit in memory, e.g.\n"
+     "    sort(@, 1000000000).\n"
+     "\n"
      "sort a, ... -> Arr[a]\n"
      "    returns an array with the input elements, except sorted.\n"
      "\n"
@@ -1257,12 +1292,23 @@ static const char* _help[][2] = {
      "\n"
      "Returns an aggregator for estimating the number of unique values. A\n"
      "statistical estimator (HyperLogLog) is used instead of exact counts;\n"
-     "memory usage is constant. Note: the estimator works better with larger\n"
-     "counts of unique values. See also 'uniques'.\n"
+     "memory usage is constant. Small counts (up to 2^p/8 values) are exact.\n"
+     "See also 'uniques', 'uniques_estimate_prec'.\n"
      "\n"
      "Usage:\n"
      "\n"
      "uniques_estimate a -> UInt\n"
+     "    the precision p is 12.\n"
+    },
+    {"uniques_estimate_prec",
+     "\n"
+     "Like 'uniques_estimate', but with the precision p given as the second\n"
+     "argument: an integer literal between 4 and 18. The estimator uses 2^p\n"
+     "bytes of memory and has a relative error of about 1.04/sqrt(2^p).\n"
+     "\n"
+     "Usage:\n"
+     "\n"
+     "uniques_estimate_prec a, Integer -> UInt\n"
     },
     {"until",
      "\n"
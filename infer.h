@@ -37,7 +37,19 @@ struct Functions {
         seqmaker = sm;
     }
 
+    // Names starting with "__" are only produced by the optimizer and can't
+    // be called from programs.
     val_t get(const String& name, const Type& args, obj::Object*& holder) const {
+
+        const std::string& n = strings().get(name);
+
+        if (n.size() >= 2 && n[0] == '_' && n[1] == '_')
+            throw std::runtime_error("Invalid function call: " + n + " " + Type::print(args) + "\nThis function doesn't exist.");
+
+        return get_internal(name, args, holder);
+    }
+
+    val_t get_internal(const String& name, const Type& args, obj::Object*& holder) const {
             
         auto i = funcs.find(key_t(name, args));
 
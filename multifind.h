@@ -0,0 +1,392 @@
+#ifndef __TAB_MULTIFIND_H
+#define __TAB_MULTIFIND_H
+
+// Searching for many literal strings at once, for 'findif' and 'findall'
+// with an array of patterns.
+//
+// The patterns are compiled into an Aho-Corasick automaton: one pass over
+// the input finds every occurrence of every pattern, however many there
+// are. While the automaton is in its start state, the bytes that can't
+// begin a pattern are skipped without stepping it.
+//
+// Up to eight patterns are instead looked for sixteen positions at a time
+// (the 'Teddy' algorithm): each position is classified by the nibbles of
+// its first three bytes into the patterns that could start there, and only
+// those are compared.
+
+namespace tab {
+
+namespace multifind {
+
+struct Matcher {
+
+    enum : uint32_t {
+        NONE = 0xFFFFFFFF,
+        TEDDY_MAX = 8
+    };
+
+    std::vector<std::string> patterns;
+
+    // Automaton states are rows of 'nclasses' transitions; bytes that
+    // don't appear in any pattern all share class 0.
+    unsigned char classes[256];
+    size_t nclasses;
+    std::vector<uint32_t> next;
+
+    // The patterns that end in a state, as a list linked through 'chain'.
+    std::vector<uint32_t> out;
+    std::vector<uint32_t> chain;
+
+    bool start[256];
+    int nstart;
+    unsigned char start_byte;
+
+    bool teddy;
+    size_t teddy_len;
+    unsigned char teddy_lo[3][16];
+    unsigned char teddy_hi[3][16];
+
+    std::vector<uint32_t> seen;
+    uint32_t seen_gen;
+
+    bool ready;
+
+    Matcher() : nclasses(1), nstart(0), start_byte(0), teddy(false), teddy_len(0), seen_gen(0), ready(false) {
+        compile();
+    }
+
+    // With 'fixed', 'p' is known to be the same as on every other call, so
+    // it is only compared and compiled the first time.
+    void set(const std::vector<std::string>& p, bool fixed = false) {
+
+        if (fixed && ready)
+            return;
+
+        ready = true;
+
+        if (p == patterns)
+            return;
+
+        patterns = p;
+        compile();
+    }
+
+    void compile() {
+
+        ::memset(classes, 0, sizeof(classes));
+        nclasses = 1;
+
+        for (const std::string& p : patterns) {
+            for (unsigned char c : p) {
+                if (classes[c] == 0)
+                    classes[c] = nclasses++;
+            }
+        }
+
+        next.assign(nclasses, NONE);
+        out.assign(1, NONE);
+        chain.assign(patterns.size(), NONE);
+
+        for (size_t i = 0; i < patterns.size(); ++i) {
+
+            uint32_t s = 0;
+
+            for (unsigned char c : patterns[i]) {
+
+                uint32_t& t = next[s * nclasses + classes[c]];
+
+                if (t == NONE) {
+                    t = out.size();
+                    next.resize(next.size() + nclasses, NONE);
+                    out.push_back(NONE);
+                }
+
+                s = next[s * nclasses + classes[c]];
+            }
+
+            chain[i] = out[s];
+            out[s] = i;
+        }
+
+        // Breadth-first, so that a state's failure link is finished before
+        // the state itself.
+        std::vector<uint32_t> fail(out.size(), 0);
+        std::vector<uint32_t> queue;
+
+        for (size_t c = 0; c < nclasses; ++c) {
+
+            uint32_t& t = next[c];
+
+            if (t == NONE) {
+                t = 0;
+            } else {
+                queue.push_back(t);
+            }
+        }
+
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+
+            uint32_t s = queue[qi];
+            uint32_t f = fail[s];
+
+            if (out[s] == NONE) {
+                out[s] = out[f];
+
+            } else {
+                uint32_t i = out[s];
+
+                while (chain[i] != NONE)
+                    i = chain[i];
+
+                chain[i] = out[f];
+            }
+
+            for (size_t c = 0; c < nclasses; ++c) {
+
+                uint32_t& t = next[s * nclasses + c];
+
+                if (t == NONE) {
+                    t = next[f * nclasses + c];
+                } else {
+                    fail[t] = next[f * nclasses + c];
+                    queue.push_back(t);
+                }
+            }
+        }
+
+        ::memset(start, 0, sizeof(start));
+        nstart = 0;
+
+        for (const std::string& p : patterns) {
+
+            if (p.empty())
+                continue;
+
+            unsigned char c = p[0];
+
+            if (!start[c]) {
+                start[c] = true;
+                start_byte = c;
+                ++nstart;
+            }
+        }
+
+        seen.assign(patterns.size(), 0);
+        seen_gen = 0;
+
+        compile_teddy();
+    }
+
+    void compile_teddy() {
+
+        teddy = false;
+
+        if (patterns.empty() || patterns.size() > TEDDY_MAX || !teddy_supported())
+            return;
+
+        teddy_len = 3;
+
+        for (const std::string& p : patterns) {
+            teddy_len = std::min(teddy_len, p.size());
+        }
+
+        if (teddy_len == 0)
+            return;
+
+        ::memset(teddy_lo, 0, sizeof(teddy_lo));
+        ::memset(teddy_hi, 0, sizeof(teddy_hi));
+
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            for (size_t j = 0; j < teddy_len; ++j) {
+
+                unsigned char c = patterns[i][j];
+
+                teddy_lo[j][c & 0xF] |= (1 << i);
+                teddy_hi[j][c >> 4] |= (1 << i);
+            }
+        }
+
+        teddy = true;
+    }
+
+    static bool teddy_supported() {
+
+#if defined(__SSE2__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+#else
+        return false;
+#endif
+    }
+
+    const char* skip(const char* b, const char* e) const {
+
+        if (nstart == 1)
+            return scan::find_byte(b, e, start_byte);
+
+        while (b != e && !start[(unsigned char)*b])
+            ++b;
+
+        return b;
+    }
+
+    bool matches_at(const char* b, const char* e, size_t i) const {
+
+        const std::string& p = patterns[i];
+
+        return ((size_t)(e - b) >= p.size() && ::memcmp(b, p.data(), p.size()) == 0);
+    }
+
+#if defined(__SSE2__) && defined(__GNUC__)
+
+    // Calls 'f' with the patterns that occur at each position, and stops
+    // when it returns false.
+    template <typename F>
+    __attribute__((target("ssse3")))
+    void teddy_each(const char* b, const char* e, F f) const {
+
+        const __m128i nibble = _mm_set1_epi8(0xF);
+        __m128i lo[3];
+        __m128i hi[3];
+
+        for (size_t j = 0; j < teddy_len; ++j) {
+            lo[j] = _mm_loadu_si128((const __m128i*)teddy_lo[j]);
+            hi[j] = _mm_loadu_si128((const __m128i*)teddy_hi[j]);
+        }
+
+        while ((size_t)(e - b) >= 16 + teddy_len - 1) {
+
+            __m128i res = _mm_set1_epi8(-1);
+
+            for (size_t j = 0; j < teddy_len; ++j) {
+
+                __m128i x = _mm_loadu_si128((const __m128i*)(b + j));
+                __m128i xl = _mm_and_si128(x, nibble);
+                __m128i xh = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+
+                res = _mm_and_si128(res, _mm_and_si128(_mm_shuffle_epi8(lo[j], xl),
+                                                       _mm_shuffle_epi8(hi[j], xh)));
+            }
+
+            unsigned int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(res, _mm_setzero_si128())) & 0xFFFF;
+
+            if (mask != 0) {
+
+                unsigned char buckets[16];
+                _mm_storeu_si128((__m128i*)buckets, res);
+
+                while (mask != 0) {
+
+                    unsigned int k = __builtin_ctz(mask);
+                    unsigned int bits = buckets[k];
+
+                    while (bits != 0) {
+
+                        unsigned int i = __builtin_ctz(bits);
+
+                        if (matches_at(b + k, e, i) && !f(i))
+                            return;
+
+                        bits &= bits - 1;
+                    }
+
+                    mask &= mask - 1;
+                }
+            }
+
+            b += 16;
+        }
+
+        for (; b != e; ++b) {
+            for (size_t i = 0; i < patterns.size(); ++i) {
+
+                if (matches_at(b, e, i) && !f(i))
+                    return;
+            }
+        }
+    }
+
+#else
+
+    template <typename F>
+    void teddy_each(const char* b, const char* e, F f) const {}
+
+#endif
+
+    template <typename F>
+    void each(const char* b, const char* e, F f) const {
+
+        if (teddy) {
+            teddy_each(b, e, f);
+            return;
+        }
+
+        for (uint32_t i = out[0]; i != NONE; i = chain[i]) {
+            if (!f(i))
+                return;
+        }
+
+        uint32_t s = 0;
+
+        while (b != e) {
+
+            if (s == 0) {
+                b = skip(b, e);
+
+                if (b == e)
+                    break;
+            }
+
+            s = next[s * nclasses + classes[(unsigned char)*b]];
+            ++b;
+
+            for (uint32_t i = out[s]; i != NONE; i = chain[i]) {
+                if (!f(i))
+                    return;
+            }
+        }
+    }
+
+    bool any(const char* b, const char* e) const {
+
+        bool ret = false;
+
+        each(b, e, [&](uint32_t) {
+            ret = true;
+            return false;
+        });
+
+        return ret;
+    }
+
+    // The patterns that occur, in order and without repeats.
+    void all(const char* b, const char* e, std::vector<UInt>& ret) {
+
+        ret.clear();
+
+        ++seen_gen;
+
+        if (seen_gen == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            seen_gen = 1;
+        }
+
+        each(b, e, [&](uint32_t i) {
+
+            if (seen[i] != seen_gen) {
+                seen[i] = seen_gen;
+                ret.push_back(i);
+            }
+
+            return (ret.size() < patterns.size());
+        });
+
+        std::sort(ret.begin(), ret.end());
+    }
+};
+
+} // namespace multifind
+
+} // namespace tab
+
+#endif
@@ -0,0 +1,454 @@
+#ifndef __TAB_NUMBER_H
+#define __TAB_NUMBER_H
+
+// Number parsing for the 'int', 'uint' and 'real' conversions.
+//
+// These accept exactly what 'strtol(s, &e, 0)', 'strtoul(s, &e, 0)' and
+// 'strtod()' accept (leading whitespace, a sign, '0x' and '0' prefixes for
+// integers, trailing garbage is ignored), and fail where those would set
+// 'e == s' or 'ERANGE'. But they work on a range of chars and don't look
+// at the locale.
+//
+// Reals with at most 19 significant digits and a small exponent are
+// converted exactly with a single multiplication or division by a power
+// of ten (Clinger's fast path); anything else is handed to 'strtod()'.
+//
+// The 'format_' functions go the other way for the printer: they write
+// into a buffer of at least 'FORMAT_SPACE' chars and return the length.
+
+namespace tab {
+
+namespace number {
+
+inline bool is_space(char c) {
+    return (c == ' ' || (c >= '\t' && c <= '\r'));
+}
+
+inline int digit_value(char c) {
+
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+
+    return 99;
+}
+
+// Parses the sign, prefix and digits; 'mag' is the absolute value.
+inline bool parse_magnitude(const char* b, const char* e, bool& neg, UInt& mag) {
+
+    while (b != e && is_space(*b))
+        ++b;
+
+    neg = false;
+
+    if (b != e && (*b == '-' || *b == '+')) {
+        neg = (*b == '-');
+        ++b;
+    }
+
+    unsigned int base = 10;
+
+    if (b != e && *b == '0') {
+
+        if (e - b > 2 && (b[1] == 'x' || b[1] == 'X') && digit_value(b[2]) < 16) {
+            base = 16;
+            b += 2;
+
+        } else {
+            base = 8;
+        }
+    }
+
+    const char* start = b;
+    const UInt cutoff = std::numeric_limits<UInt>::max() / base;
+    const unsigned int cutlim = std::numeric_limits<UInt>::max() % base;
+
+    mag = 0;
+    bool overflow = false;
+
+    for (; b != e; ++b) {
+
+        unsigned int d = digit_value(*b);
+
+        if (d >= base)
+            break;
+
+        if (mag > cutoff || (mag == cutoff && d > cutlim)) {
+            overflow = true;
+        }
+
+        mag = mag * base + d;
+    }
+
+    return (b != start && !overflow);
+}
+
+inline bool parse_int(const char* b, const char* e, Int& out) {
+
+    bool neg;
+    UInt mag;
+
+    if (!parse_magnitude(b, e, neg, mag))
+        return false;
+
+    const UInt max = (UInt)std::numeric_limits<Int>::max();
+
+    if (neg) {
+
+        if (mag > max + 1)
+            return false;
+
+        out = (mag == max + 1 ? std::numeric_limits<Int>::min() : -(Int)mag);
+
+    } else {
+
+        if (mag > max)
+            return false;
+
+        out = (Int)mag;
+    }
+
+    return true;
+}
+
+inline bool parse_uint(const char* b, const char* e, UInt& out) {
+
+    bool neg;
+    UInt mag;
+
+    if (!parse_magnitude(b, e, neg, mag))
+        return false;
+
+    // Like 'strtoul()', a minus sign negates in unsigned arithmetic.
+    out = (neg ? -mag : mag);
+    return true;
+}
+
+inline bool parse_real_slow(const char* b, const char* e, Real& out) {
+
+    static thread_local std::string buf;
+    buf.assign(b, e);
+
+    const char* s = buf.c_str();
+    char* end;
+
+    errno = 0;
+    out = ::strtod(s, &end);
+
+    return (end != s && errno != ERANGE);
+}
+
+inline bool parse_real(const char* b, const char* e, Real& out) {
+
+    static const Real powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* i = b;
+
+    while (i != e && is_space(*i))
+        ++i;
+
+    bool neg = false;
+
+    if (i != e && (*i == '-' || *i == '+')) {
+        neg = (*i == '-');
+        ++i;
+    }
+
+    // Hex floats.
+    if (i != e && (*i == '0') && (e - i > 1) && (i[1] == 'x' || i[1] == 'X'))
+        return parse_real_slow(b, e, out);
+
+    uint64_t mant = 0;
+    int ndigits = 0;
+    int exp10 = 0;
+    bool any = false;
+
+    for (; i != e && *i >= '0' && *i <= '9'; ++i) {
+        any = true;
+
+        if (mant == 0 && *i == '0')
+            continue;
+
+        if (ndigits < 19) {
+            mant = mant * 10 + (*i - '0');
+        } else {
+            ++exp10;
+        }
+
+        ++ndigits;
+    }
+
+    if (i != e && *i == '.') {
+        ++i;
+
+        for (; i != e && *i >= '0' && *i <= '9'; ++i) {
+            any = true;
+
+            if (mant == 0 && *i == '0') {
+                --exp10;
+                continue;
+            }
+
+            if (ndigits < 19) {
+                mant = mant * 10 + (*i - '0');
+                --exp10;
+            }
+
+            ++ndigits;
+        }
+    }
+
+    // 'inf', 'nan' or not a number at all.
+    if (!any)
+        return parse_real_slow(b, e, out);
+
+    if (i != e && (*i == 'e' || *i == 'E')) {
+
+        const char* j = i + 1;
+        bool eneg = false;
+
+        if (j != e && (*j == '-' || *j == '+')) {
+            eneg = (*j == '-');
+            ++j;
+        }
+
+        if (j != e && *j >= '0' && *j <= '9') {
+
+            int x = 0;
+
+            for (; j != e && *j >= '0' && *j <= '9'; ++j) {
+                if (x < 100000)
+                    x = x * 10 + (*j - '0');
+            }
+
+            exp10 += (eneg ? -x : x);
+        }
+    }
+
+    if (mant == 0) {
+        out = (neg ? -0.0 : 0.0);
+        return true;
+    }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+
+    if (ndigits <= 19 && mant <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+
+        Real v = (Real)mant;
+
+        if (exp10 < 0) {
+            v /= powers[-exp10];
+        } else {
+            v *= powers[exp10];
+        }
+
+        out = (neg ? -v : v);
+        return true;
+    }
+
+#endif
+
+    return parse_real_slow(b, e, out);
+}
+
+static const size_t FORMAT_SPACE = 32;
+
+inline size_t format_uint(UInt v, char* out) {
+
+    static const char digits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    char tmp[FORMAT_SPACE];
+    char* e = tmp + sizeof(tmp);
+    char* i = e;
+
+    while (v >= 100) {
+        size_t d = (v % 100) * 2;
+        v /= 100;
+        *--i = digits[d + 1];
+        *--i = digits[d];
+    }
+
+    if (v >= 10) {
+        *--i = digits[v * 2 + 1];
+        *--i = digits[v * 2];
+    } else {
+        *--i = '0' + v;
+    }
+
+    ::memcpy(out, i, e - i);
+    return e - i;
+}
+
+inline size_t format_int(Int v, char* out) {
+
+    if (v < 0) {
+        *out = '-';
+        return 1 + format_uint(-(UInt)v, out + 1);
+    }
+
+    return format_uint(v, out);
+}
+
+inline size_t format_hex(UInt v, char* out) {
+
+    static const char digits[] = "0123456789ABCDEF";
+
+    char tmp[FORMAT_SPACE];
+    char* e = tmp + sizeof(tmp);
+    char* i = e;
+
+    do {
+        *--i = digits[v & 0xF];
+        v >>= 4;
+    } while (v);
+
+    out[0] = '0';
+    out[1] = 'x';
+    ::memcpy(out + 2, i, e - i);
+    return 2 + (e - i);
+}
+
+// Exactly printf's '%g'. The six digits are found with one multiplication or
+// division by an exact power of ten, so cases too close to a rounding tie
+// for that to be trustworthy go to 'snprintf()'.
+inline size_t format_g(Real v, char* out) {
+
+    static const Real powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    Real a = std::fabs(v);
+
+    if (!(a >= 1e-15 && a < 1e20))
+        return ::snprintf(out, FORMAT_SPACE, "%g", v);
+
+    int exp = (int)std::floor(std::log10(a));
+    UInt d = 0;
+
+    for (int tries = 0; tries < 3; ++tries) {
+
+        int k = 5 - exp;
+        Real s = (k >= 0 ? a * powers[k] : a / powers[-k]);
+
+        if (std::fabs(s - std::floor(s) - 0.5) < 1e-6)
+            return ::snprintf(out, FORMAT_SPACE, "%g", v);
+
+        d = (UInt)(s + 0.5);
+
+        if (d >= 1000000) {
+            ++exp;
+        } else if (d < 100000) {
+            --exp;
+        } else {
+            break;
+        }
+    }
+
+    if (d < 100000 || d >= 1000000)
+        return ::snprintf(out, FORMAT_SPACE, "%g", v);
+
+    char digits[6];
+    format_uint(d, digits);
+
+    size_t nd = 6;
+
+    while (nd > 1 && digits[nd - 1] == '0')
+        --nd;
+
+    char* i = out;
+
+    if (v < 0)
+        *i++ = '-';
+
+    if (exp < -4 || exp >= 6) {
+
+        *i++ = digits[0];
+
+        if (nd > 1) {
+            *i++ = '.';
+            ::memcpy(i, digits + 1, nd - 1);
+            i += nd - 1;
+        }
+
+        *i++ = 'e';
+        *i++ = (exp < 0 ? '-' : '+');
+
+        int x = (exp < 0 ? -exp : exp);
+
+        if (x < 10)
+            *i++ = '0';
+
+        i += format_uint(x, i);
+
+    } else if (exp >= 0) {
+
+        ::memcpy(i, digits, exp + 1);
+        i += exp + 1;
+
+        if (nd > (size_t)exp + 1) {
+            *i++ = '.';
+            ::memcpy(i, digits + exp + 1, nd - exp - 1);
+            i += nd - exp - 1;
+        }
+
+    } else {
+
+        *i++ = '0';
+        *i++ = '.';
+
+        for (int z = -1; z > exp; --z)
+            *i++ = '0';
+
+        ::memcpy(i, digits, nd);
+        i += nd;
+    }
+
+    return i - out;
+}
+
+// Like printf's '%g' by default. With 'roundtrip', uses the fewest of 15, 16
+// or 17 significant digits that read back as exactly the same number.
+inline size_t format_real(Real v, char* out, bool roundtrip) {
+
+    // Whole numbers that '%g' (or '%.15g') would print without an exponent.
+    Real limit = (roundtrip ? 1e15 : 1e6);
+
+    if (v > -limit && v < limit && v == (Real)(Int)v && !(v == 0 && std::signbit(v)))
+        return format_int((Int)v, out);
+
+    if (!roundtrip)
+        return format_g(v, out);
+
+    if (!std::isfinite(v))
+        return ::snprintf(out, FORMAT_SPACE, "%g", v);
+
+    int n = 0;
+
+    for (int prec = 15; prec <= 17; ++prec) {
+
+        n = ::snprintf(out, FORMAT_SPACE, "%.*g", prec, v);
+
+        if (::strtod(out, nullptr) == v)
+            break;
+    }
+
+    return n;
+}
+
+} // namespace number
+
+} // namespace tab
+
+#endif
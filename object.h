@@ -5,53 +5,94 @@ namespace tab {
 
 namespace obj {
 
+// Reals are printed like '%g' unless this is set.
+bool& print_roundtrip_reals() {
+    static bool ret = false;
+    return ret;
+}
+
+// Prints to stdout through a private buffer, written out in large blocks.
+// 'PrinterStr' overrides everything to print into a string instead.
+
 struct Printer {
 
     bool null;
+    std::string out;
+
+    static const size_t BUFSIZE = 64*1024;
+
     Printer() : null(true) {}
 
+    virtual ~Printer() {
+        flush();
+    }
+
     void bump() { null = false; }
 
-    virtual void val(tab::UInt v) { bump(); printf("%lu", v); }
-    virtual void val(tab::Int v)  { bump(); printf("%ld", v); }
-    virtual void val(tab::Real v) { bump(); printf("%g", v); }
-    virtual void hex(tab::UInt v) { bump(); printf("0x%lX", v); }
+    void flush() {
+        if (!out.empty()) {
+            fwrite(out.data(), sizeof(char), out.size(), stdout);
+            out.clear();
+        }
+    }
+
+    void write(const char* s, size_t n) {
+
+        if (out.capacity() < BUFSIZE)
+            out.reserve(BUFSIZE);
+
+        out.append(s, n);
+
+        if (out.size() >= BUFSIZE)
+            flush();
+    }
+
+    void write(char c) {
+        out += c;
+
+        if (out.size() >= BUFSIZE)
+            flush();
+    }
+
+    virtual void val(tab::UInt v) { bump(); char tmp[number::FORMAT_SPACE]; write(tmp, number::format_uint(v, tmp)); }
+    virtual void val(tab::Int v)  { bump(); char tmp[number::FORMAT_SPACE]; write(tmp, number::format_int(v, tmp)); }
+    virtual void val(tab::Real v) {
+        bump();
+        char tmp[number::FORMAT_SPACE];
+        write(tmp, number::format_real(v, tmp, print_roundtrip_reals()));
+    }
+    virtual void hex(tab::UInt v) { bump(); char tmp[number::FORMAT_SPACE]; write(tmp, number::format_hex(v, tmp)); }
 
     virtual void val(const std::string& v) {
         bump();
-        fwrite(v.data(), sizeof(char), v.size(), stdout);
+        write(v.data(), v.size());
     }
 
-    virtual void rs() { bump(); printf("\t"); }
-    virtual void nl() { bump(); printf("\n"); }
-    virtual void alts() { bump(); printf(";"); }
+    virtual void rs() { bump(); write('\t'); }
+    virtual void nl() { bump(); write('\n'); }
+    virtual void alts() { bump(); write(';'); }
 };
 
 template <bool COMPACT=false>
 struct PrinterStr : public Printer {
     std::string buff;
-    static const size_t SPACE = 64;
-    char tmp[SPACE];
-
-    template <typename V>
-    void val_(const char* format, V v) {
-        int n = snprintf(tmp, SPACE, format, v);
-        if ((size_t)n >= SPACE) {
-            throw std::runtime_error("snprintf overflow sanity error.");
-        }
-        buff += tmp;
-    }
+    char tmp[number::FORMAT_SPACE];
 
-    virtual void val(tab::UInt v) { val_("%lu", v); }
-    virtual void val(tab::Int v)  { val_("%ld", v); }
-    virtual void val(tab::Real v) { val_("%g", v); }
+    virtual void val(tab::UInt v) { buff.append(tmp, number::format_uint(v, tmp)); }
+    virtual void val(tab::Int v)  { buff.append(tmp, number::format_int(v, tmp)); }
+    virtual void val(tab::Real v) { buff.append(tmp, number::format_real(v, tmp, print_roundtrip_reals())); }
     virtual void val(const std::string& v) { buff += v; }
-    virtual void hex(tab::UInt v) { val_("0x%lX", v); }
+    virtual void hex(tab::UInt v) { buff.append(tmp, number::format_hex(v, tmp)); }
     virtual void rs() { if (!COMPACT) { buff += "\t"; } }
     virtual void nl() { buff += "\n"; }
     virtual void alts() { buff += ";"; }
 };
 
+// What 'merge()' does for atoms whose whole state is their value; see
+// 'MapAtom'.
+
+enum merge_t { MERGE_OTHER, MERGE_FIRST, MERGE_ADD, MERGE_MUL, MERGE_MIN, MERGE_MAX };
+
 struct Object {
 
     virtual ~Object() {}
@@ -60,6 +101,11 @@ struct Object {
         throw std::runtime_error("Object hash not implemented");
     }
 
+    // 'fnv_hash()' is the slower, stable hash shown by the 'hash' builtin.
+    virtual hash_t fnv_hash() const {
+        return hash();
+    }
+
     virtual bool eq(Object*) const {
         throw std::runtime_error("Object equality not implemented");
     }
@@ -82,8 +128,21 @@ struct Object {
     
     virtual Object* next() { throw std::runtime_error("Object 'next' operator not implemented"); }
 
+    // Drops up to 'n' elements of a sequence; returns how many it dropped.
+    virtual UInt skip(UInt n) {
+
+        UInt i = 0;
+
+        while (i < n && next())
+            ++i;
+
+        return i;
+    }
+
     virtual void merge(const Object*) {}
     virtual void merge_end() {}
+
+    virtual merge_t merge_kind() const { return MERGE_OTHER; }
 };
 
 template <typename T>
@@ -96,17 +155,122 @@ Object* nothing() {
     return ret;
 }
 
+// Atoms are created and destroyed by the million as keys and values of maps
+// that can't keep them inline (see 'MapAtom') and as aggregator results, so
+// they are carved out of per-thread slabs instead of going through malloc
+// one by one.
+//
+// Every slab starts with a pointer to the heap of the thread that carved
+// it. A block freed by another thread (e.g. a result cloned by a worker
+// thread and dropped by the main thread) is pushed onto its owner's
+// 'remote' list, which the owner takes over whenever its own list runs dry.
+
+struct SmallAlloc {
+
+    static const size_t GRAIN = 16;
+    static const size_t CLASSES = 8;
+    static const size_t SLAB = 64*1024;
+
+    struct Heap {
+        void* local[CLASSES];
+        std::atomic<void*> remote[CLASSES];
+
+        Heap() {
+            for (size_t c = 0; c < CLASSES; ++c) {
+                local[c] = nullptr;
+                remote[c] = nullptr;
+            }
+        }
+    };
+
+    // Never deleted: other threads may still free blocks into a heap after
+    // its thread has exited.
+    static Heap* heap() {
+        static thread_local Heap* ret = new Heap;
+        return ret;
+    }
+
+    static void* alloc(size_t n) {
+
+        size_t c = (n - 1) / GRAIN;
+
+        if (c >= CLASSES)
+            return ::operator new(n);
+
+        Heap* h = heap();
+        void*& head = h->local[c];
+
+        if (!head)
+            head = h->remote[c].exchange(nullptr, std::memory_order_acquire);
+
+        if (!head) {
+            size_t size = (c + 1) * GRAIN;
+            void* slab;
+
+            if (::posix_memalign(&slab, SLAB, SLAB) != 0)
+                throw std::bad_alloc();
+
+            *(Heap**)slab = h;
+
+            for (size_t i = size; i + size <= SLAB; i += size) {
+                *(void**)((char*)slab + i) = head;
+                head = (char*)slab + i;
+            }
+        }
+
+        void* ret = head;
+        head = *(void**)head;
+        return ret;
+    }
+
+    static void free(void* p, size_t n) {
+
+        size_t c = (n - 1) / GRAIN;
+
+        if (c >= CLASSES) {
+            ::operator delete(p);
+            return;
+        }
+
+        Heap* owner = *(Heap**)((uintptr_t)p & ~(uintptr_t)(SLAB - 1));
+
+        if (owner == heap()) {
+            void*& head = owner->local[c];
+            *(void**)p = head;
+            head = p;
+            return;
+        }
+
+        std::atomic<void*>& head = owner->remote[c];
+        void* old = head.load(std::memory_order_relaxed);
+
+        do {
+            *(void**)p = old;
+        } while (!head.compare_exchange_weak(old, p, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
+
 template <typename T>
 struct Atom : public Object {
     T v;
 
     Atom(const T& i = T()) : v(i) {}
 
-    hash_t hash() const { return do_hash(v, fnv_basis()); }
+    static void* operator new(size_t n) { return SmallAlloc::alloc(n); }
+    static void operator delete(void* p, size_t n) { SmallAlloc::free(p, n); }
+
+    hash_t hash() const { return fast_hash(v); }
+    hash_t fnv_hash() const { return do_hash(v, fnv_basis()); }
     bool eq(Object* a) const { return v == get< Atom<T> >(a).v; }
     bool less(Object* a) const { return v < get< Atom<T> >(a).v; }
     void print(Printer& p) { p.val(v); }
     Object* clone() const { return new Atom<T>(v); }
+
+    // Subclasses that don't say otherwise have some state or behaviour of
+    // their own.
+    merge_t merge_kind() const {
+        return (typeid(*this) == typeid(Atom<T>) ? MERGE_FIRST : MERGE_OTHER);
+    }
 };
 
 typedef Atom<tab::Int> Int;
@@ -120,6 +284,14 @@ struct ArrayAtom : public Object {
     std::vector<T> v;
 
     hash_t hash() const {
+        hash_t ret = 0;
+        for (const T& t : v) {
+            ret = fast_hash_combine(fast_hash(t), ret);
+        }
+        return ret;
+    }
+
+    hash_t fnv_hash() const {
         hash_t ret = fnv_basis();
         for (const T& t : v) {
             ret = do_hash(t, ret);
@@ -193,9 +365,17 @@ struct ArrayObject : public Object {
     }
     
     hash_t hash() const {
+        hash_t ret = 0;
+        for (Object* t : v) {
+            ret = fast_hash_combine(t->hash(), ret);
+        }
+        return ret;
+    }
+
+    hash_t fnv_hash() const {
         hash_t ret = fnv_basis();
         for (Object* t : v) {
-            ret = do_hash(t->hash(), ret);
+            ret = do_hash(t->fnv_hash(), ret);
         }
         return ret;
     }
@@ -365,7 +545,7 @@ template <> struct _map_t<true> {
 };
 
 template <> struct _map_t<false> {
-    typedef std::unordered_map<Object*, Object*, ObjectHash, ObjectEq> type_t;
+    typedef FlatMap<Object*, Object*, ObjectHash, ObjectEq> type_t;
 };
 
 
@@ -388,12 +568,39 @@ struct MapObject : public Object {
 
         v.clear();
     }
+
+    virtual size_t size() const {
+        return v.size();
+    }
+
+    // Makes sure every entry is in 'v'. (See 'MapAtom'.)
+    virtual void box() {}
     
+    // Unsorted maps don't have a canonical order, so their hash and
+    // equality must not depend on the order of iteration.
+
     hash_t hash() const {
+        hash_t ret = 0;
+        for (const auto& t : v) {
+            if (SORTED) {
+                ret = fast_hash_combine(t.first->hash(), ret);
+                ret = fast_hash_combine(t.second->hash(), ret);
+            } else {
+                ret += fast_hash_combine(t.second->hash(), t.first->hash());
+            }
+        }
+        return ret;
+    }
+
+    hash_t fnv_hash() const {
         hash_t ret = fnv_basis();
         for (const auto& t : v) {
-            ret = do_hash(t.first->hash(), ret);
-            ret = do_hash(t.second->hash(), ret);
+            if (SORTED) {
+                ret = do_hash(t.first->fnv_hash(), ret);
+                ret = do_hash(t.second->fnv_hash(), ret);
+            } else {
+                ret += do_hash(t.second->fnv_hash(), do_hash(t.first->fnv_hash(), fnv_basis()));
+            }
         }
         return ret;
     }
@@ -405,6 +612,18 @@ struct MapObject : public Object {
         if (v.size() != b.size())
             return false;
 
+        if (!SORTED) {
+
+            for (const auto& t : v) {
+                auto j = b.find(t.first);
+
+                if (j == b.end() || !(t.second->eq(j->second)))
+                    return false;
+            }
+
+            return true;
+        }
+
         auto i = v.begin();
         auto ie = v.end();
         auto j = b.begin();
@@ -484,20 +703,37 @@ struct MapObject : public Object {
         return ret;
     }
 
-    void insert(Object* key, Object* val) {
+    template <typename M>
+    static void insert(M& m, Object* key, Object* val) {
 
-        auto i = v.find(key);
+        auto i = m.find(key);
             
-        if (i != v.end()) {
+        if (i != m.end()) {
             i->second->merge(val);
 
         } else {
             key = key->clone();
             val = val->clone();
-            v[key] = val;
+            m[key] = val;
+        }
+    }
+
+    // Hashes the key only once.
+    static void insert(FlatMap<Object*, Object*, ObjectHash, ObjectEq>& m, Object* key, Object* val) {
+
+        auto i = m.find_or_insert(key, key->hash(), [&]() {
+                return std::make_pair(key->clone(), val->clone());
+            });
+
+        if (!i.second) {
+            i.first->second->merge(val);
         }
     }
 
+    void insert(Object* key, Object* val) {
+        insert(v, key, val);
+    }
+
     void fill(Object* seq) {
 
         clear();
@@ -532,6 +768,27 @@ struct MapObject : public Object {
         }
     }
 
+    // Like 'merge()', but takes ownership of the other map's keys and
+    // values instead of cloning them. The other map is left empty.
+    virtual void merge_move(MapObject<SORTED>& t) {
+
+        if (v.size() < t.v.size())
+            std::swap(v, t.v);
+
+        for (const auto& i : t.v) {
+
+            auto j = v.insert(i);
+
+            if (!j.second) {
+                j.first->second->merge(i.second);
+                delete i.first;
+                delete i.second;
+            }
+        }
+
+        t.v.clear();
+    }
+
     void merge_end() {
         for (auto& i : v) {
             i.second->merge_end();
@@ -540,6 +797,299 @@ struct MapObject : public Object {
 };
 
 
+// Maps from atoms to numbers keep their entries inline when every value
+// merges like a plain number ('sum()', 'min()', a bare value, ...), which
+// is what '{ @ -> sum(1) }' needs: no key or value objects per entry.
+//
+// Which aggregator the values come from is only known once they arrive.
+// Anything that doesn't fit, and any code that needs the entries as objects,
+// calls 'box()' and the map falls back to 'v' for good.
+
+template <typename K, typename V>
+struct MapAtom : public MapObject<false> {
+
+    struct hasher {
+        hash_t operator()(const K& k) const {
+            return fast_hash(k);
+        }
+    };
+
+    typedef FlatMap<K, V, hasher, std::equal_to<K>> inline_t;
+
+    inline_t a;
+    bool boxed;
+
+    // A value of the aggregator's class, to box values with.
+    Object* proto;
+    merge_t kind;
+
+    MapAtom() : boxed(false), proto(nullptr), kind(MERGE_OTHER) {}
+
+    ~MapAtom() {
+        delete proto;
+    }
+
+    void clear() {
+        MapObject<false>::clear();
+        a.clear();
+        boxed = false;
+        delete proto;
+        proto = nullptr;
+    }
+
+    size_t size() const {
+        return (boxed ? v.size() : a.size());
+    }
+
+    void box() {
+
+        if (boxed)
+            return;
+
+        boxed = true;
+        v.reserve(a.size());
+
+        for (const auto& x : a) {
+            Object* val = proto->clone();
+            get< Atom<V> >(val).v = x.second;
+            v.insert_hashed(new Atom<K>(x.first), val, x.hash);
+        }
+
+        a = inline_t();
+    }
+
+    static void merge_value(merge_t kind, V& x, V y) {
+
+        switch (kind) {
+        case MERGE_ADD:
+            x += y;
+            break;
+        case MERGE_MUL:
+            x *= y;
+            break;
+        case MERGE_MIN:
+            if (y < x) x = y;
+            break;
+        case MERGE_MAX:
+            if (y > x) x = y;
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool mergeable(const MapAtom& t) const {
+        return (!boxed && !t.boxed && (!proto || !t.proto || kind == t.kind));
+    }
+
+    void adopt(const MapAtom& t) {
+
+        if (!proto && t.proto) {
+            proto = t.proto->clone();
+            kind = t.kind;
+        }
+    }
+
+    void insert(Object* key, Object* val) {
+
+        if (!boxed && !proto) {
+
+            if (key->merge_kind() == MERGE_FIRST && val->merge_kind() != MERGE_OTHER) {
+                proto = val->clone();
+                kind = val->merge_kind();
+            } else {
+                boxed = true;
+            }
+        }
+
+        if (boxed) {
+            MapObject<false>::insert(key, val);
+            return;
+        }
+
+        const K& k = get< Atom<K> >(key).v;
+        V x = get< Atom<V> >(val).v;
+
+        auto i = a.find_or_insert(k, fast_hash(k), [&]() {
+                return std::make_pair(k, x);
+            });
+
+        if (!i.second) {
+            merge_value(kind, i.first->second, x);
+            return;
+        }
+
+        if (key->merge_kind() != MERGE_FIRST || val->merge_kind() != kind) {
+
+            // Key and value were just added as the wrong kind of object.
+            box();
+
+            auto& last = v.entries.back();
+            delete last.first;
+            delete last.second;
+            last.first = key->clone();
+            last.second = val->clone();
+        }
+    }
+
+    void fill(Object* seq) {
+
+        clear();
+
+        while (1) {
+
+            Object* next = seq->next();
+
+            if (!next) break;
+
+            Tuple& tup = get<Tuple>(next);
+
+            insert(tup.v[0], tup.v[1]);
+        }
+
+        merge_end();
+    }
+
+    void merge(const Object* v2) {
+        MapAtom& t = get<MapAtom>(v2);
+
+        if (mergeable(t)) {
+            adopt(t);
+
+            for (const auto& x : t.a) {
+                auto i = a.insert(x);
+
+                if (!i.second)
+                    merge_value(kind, i.first->second, x.second);
+            }
+
+            return;
+        }
+
+        box();
+        t.box();
+        MapObject<false>::merge(v2);
+    }
+
+    void merge_move(MapObject<false>& t0) {
+        MapAtom& t = (MapAtom&)t0;
+
+        if (mergeable(t)) {
+
+            if (a.size() < t.a.size())
+                std::swap(a, t.a);
+
+            merge(&t);
+            t.clear();
+            return;
+        }
+
+        box();
+        t.box();
+        MapObject<false>::merge_move(t);
+    }
+
+    void merge_end() {
+
+        if (boxed)
+            MapObject<false>::merge_end();
+    }
+
+    Object* clone() const {
+
+        MapAtom* ret = new MapAtom;
+
+        if (boxed) {
+            ret->boxed = true;
+            ret->v.reserve(v.size());
+
+            for (const auto& x : v) {
+                ret->v.insert_hashed(x.first->clone(), x.second->clone(), x.hash);
+            }
+
+        } else {
+            ret->a = a;
+            ret->adopt(*this);
+        }
+
+        return ret;
+    }
+
+    hash_t hash() const {
+
+        if (boxed)
+            return MapObject<false>::hash();
+
+        hash_t ret = 0;
+        for (const auto& t : a) {
+            ret += fast_hash_combine(fast_hash(t.second), t.hash);
+        }
+        return ret;
+    }
+
+    hash_t fnv_hash() const {
+
+        if (boxed)
+            return MapObject<false>::fnv_hash();
+
+        hash_t ret = fnv_basis();
+        for (const auto& t : a) {
+            ret += do_hash(do_hash(t.second, fnv_basis()), do_hash(do_hash(t.first, fnv_basis()), fnv_basis()));
+        }
+        return ret;
+    }
+
+    bool eq(Object* o) const {
+        MapAtom& b = get<MapAtom>(o);
+
+        if (boxed || b.boxed) {
+            const_cast<MapAtom*>(this)->box();
+            b.box();
+            return MapObject<false>::eq(o);
+        }
+
+        if (a.size() != b.a.size())
+            return false;
+
+        for (const auto& t : a) {
+            auto j = b.a.find(t.first);
+
+            if (j == b.a.end() || !(t.second == j->second))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool less(Object* o) const {
+        const_cast<MapAtom*>(this)->box();
+        get<MapAtom>(o).box();
+        return MapObject<false>::less(o);
+    }
+
+    void print(Printer& p) {
+
+        if (boxed) {
+            MapObject<false>::print(p);
+            return;
+        }
+
+        bool first = true;
+        for (const auto& x : a) {
+            if (first) {
+                first = false;
+            } else {
+                p.nl();
+            }
+
+            p.val(x.first);
+            p.rs();
+            p.val(x.second);
+        }
+    }
+};
+
+
 struct SeqBase : public Object {
 
     hash_t hash() const {
@@ -667,6 +1217,7 @@ struct SeqMapObject : public SeqBase {
     
     void wrap(Object* a) {
         MapObject<SORTED>* map = (MapObject<SORTED>*)a;
+        map->box();
         b = map->v.begin();
         e = map->v.end();
     }
@@ -685,20 +1236,104 @@ struct SeqMapObject : public SeqBase {
     }
 };
 
-struct SeqGenerator : public SeqBase {
+// Walks a 'MapAtom' without boxing it, through a key and a value object of
+// its own.
+
+template <typename K, typename V>
+struct SeqMapAtom : public SeqMapObject<false> {
+
+    Atom<K>* key;
+    Object* val;
+    bool boxed;
+    typename MapAtom<K,V>::inline_t::const_iterator ab;
+    typename MapAtom<K,V>::inline_t::const_iterator ae;
+
+    SeqMapAtom() : key(new Atom<K>), val(nullptr), boxed(false) {}
+
+    void wrap(Object* a) {
+        MapAtom<K,V>* map = (MapAtom<K,V>*)a;
 
-    typedef std::function<Object*()> iterator_t;
-    iterator_t v;
+        boxed = map->boxed;
 
-    void wrap(Object* o) {
-        throw std::runtime_error("Sanity error: sequence wrapping a generator.");
+        if (boxed) {
+            SeqMapObject<false>::wrap(a);
+            return;
+        }
+
+        ab = map->a.begin();
+        ae = map->a.end();
+
+        if (ab != ae && (!val || val->merge_kind() != map->kind)) {
+            delete val;
+            val = map->proto->clone();
+        }
+
+        holder->v[0] = key;
+        holder->v[1] = val;
     }
-    
+
     Object* next() {
-        return v();
+
+        if (boxed)
+            return SeqMapObject<false>::next();
+
+        if (ab == ae) {
+            return nullptr;
+        }
+
+        key->v = ab->first;
+        get< Atom<V> >(val).v = ab->second;
+        ++ab;
+
+        return holder;
     }
 };
 
+// Picks 'C<K,V>' for maps from an atom to a number, if 't' is one.
+
+template <template <typename, typename> class C, typename K>
+Object* make_map_atom(const Type& v) {
+
+    if (v.type != Type::ATOM)
+        return nullptr;
+
+    switch (v.atom) {
+    case Type::INT:
+        return new C<K, tab::Int>;
+    case Type::UINT:
+        return new C<K, tab::UInt>;
+    case Type::REAL:
+        return new C<K, tab::Real>;
+    default:
+        return nullptr;
+    }
+}
+
+template <template <typename, typename> class C>
+Object* make_map_atom(const Type& t) {
+
+    if (!t.tuple || t.tuple->size() != 2)
+        return nullptr;
+
+    const Type& k = (*t.tuple)[0];
+    const Type& v = (*t.tuple)[1];
+
+    if (k.type != Type::ATOM)
+        return nullptr;
+
+    switch (k.atom) {
+    case Type::INT:
+        return make_map_atom<C, tab::Int>(v);
+    case Type::UINT:
+        return make_map_atom<C, tab::UInt>(v);
+    case Type::REAL:
+        return make_map_atom<C, tab::Real>(v);
+    case Type::STRING:
+        return make_map_atom<C, std::string>(v);
+    }
+
+    return nullptr;
+}
 
 template <bool SORTED, typename... U>
 Object* make(const Type& t, U&&... u) {
@@ -754,6 +1389,13 @@ Object* make(const Type& t, U&&... u) {
 
     } else if (t.type == Type::MAP) {
 
+        if (!SORTED) {
+            Object* ret = make_map_atom<MapAtom>(t);
+
+            if (ret)
+                return ret;
+        }
+
         return new MapObject<SORTED>(std::forward<U>(u)...);
 
     } else if (t.type == Type::SEQ) {
@@ -774,6 +1416,13 @@ Object* make_seq_from(const Type& s) {
 
     } else if (s.type == Type::MAP) {
 
+        if (!SORTED) {
+            Object* ret = make_map_atom<SeqMapAtom>(s);
+
+            if (ret)
+                return ret;
+        }
+
         return new SeqMapObject<SORTED>;
 
     } else if (s.type == Type::ARR) {
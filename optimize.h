@@ -69,6 +69,213 @@ void remove_variable(std::vector<Command>& commands, size_t var) {
     commands.swap(ret);
 }
 
+bool is_call(const Command& c, const char* name) {
+    return (c.cmd == Command::FUN && c.arg.which == Atom::STRING && c.arg.str == strings().add(name));
+}
+
+void set_call(Command& c, const char* name, const Type& args) {
+
+    obj::Object* holder = nullptr;
+
+    c.arg = Atom(strings().add(name));
+    c.function = (void*)functions().get_internal(c.arg.str, args, holder).first;
+}
+
+// 'commands[i]' is a 'cut(String, String)' that splits into an array.
+bool is_full_cut(const std::vector<Command>& commands, size_t i) {
+
+    static const Type args(Type::TUP, { Type(Type::STRING), Type(Type::STRING) });
+
+    return (i > 0 &&
+            (is_call(commands[i], "cut") || is_call(commands[i], "split")) &&
+            commands[i - 1].cmd == Command::TUP &&
+            commands[i - 1].type == args);
+}
+
+// 'commands[i]' is 'index(Arr[String], n)' where 'n' is computed by the single
+// command just before the tuple.
+bool is_field_index(const std::vector<Command>& commands, size_t i) {
+
+    if (i + 2 >= commands.size())
+        return false;
+
+    const Command& n = commands[i];
+    const Command& tup = commands[i + 1];
+
+    return ((n.cmd == Command::VAL || n.cmd == Command::VAR) &&
+            (n.type == Type(Type::UINT) || n.type == Type(Type::INT)) &&
+            tup.cmd == Command::TUP &&
+            tup.type == Type(Type::TUP, { Type(Type::ARR, { Type(Type::STRING) }), n.type }) &&
+            is_call(commands[i + 2], "index"));
+}
+
+// 'cut(s, d)[n]' becomes '__cut_index(s, d, n)', which only scans as far
+// as the field it returns.
+void lazy_cut_index(std::vector<Command>& commands) {
+
+    for (auto& cmd : commands) {
+        for (auto& j : cmd.closure) {
+            lazy_cut_index(j.code);
+        }
+    }
+
+    for (size_t i = 1; i < commands.size(); ++i) {
+
+        if (!is_full_cut(commands, i) || !is_field_index(commands, i + 1))
+            continue;
+
+        Type args(Type::TUP, { Type(Type::STRING), Type(Type::STRING), commands[i + 1].type });
+
+        Command& tup = commands[i + 2];
+        tup.arg = Atom(UInt(3));
+        tup.type = args;
+
+        set_call(commands[i + 3], "__cut_index", args);
+
+        commands.erase(commands.begin() + i - 1, commands.begin() + i + 1);
+    }
+}
+
+struct cut_uses {
+    std::vector<Command>* write_code;
+    size_t write;
+    size_t writes;
+    bool only_indexed;
+    UInt limit;
+};
+
+void find_cut_uses(std::vector<Command>& commands, size_t var, cut_uses& ret) {
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+
+        auto& cmd = commands[i];
+
+        for (auto& j : cmd.closure) {
+            find_cut_uses(j.code, var, ret);
+        }
+
+        // Generators bind their variable without a 'VAW'.
+        if ((cmd.cmd == Command::GEN || cmd.cmd == Command::GEN_TRY || cmd.cmd == Command::REC) &&
+            cmd.arg.uint == var) {
+
+            ret.writes++;
+            continue;
+        }
+
+        if (cmd.arg.which != Atom::UINT || cmd.arg.uint != var)
+            continue;
+
+        if (cmd.cmd == Command::VAW) {
+
+            ret.writes++;
+            ret.write_code = &commands;
+            ret.write = i;
+
+        } else if (cmd.cmd == Command::VAR) {
+
+            const Command* n = (i + 1 < commands.size() ? &commands[i + 1] : nullptr);
+
+            if (!is_field_index(commands, i + 1) || n->cmd != Command::VAL) {
+                ret.only_indexed = false;
+                continue;
+            }
+
+            if (n->arg.which == Atom::INT && n->arg.inte < 0) {
+                ret.only_indexed = false;
+                continue;
+            }
+
+            UInt ix = (n->arg.which == Atom::INT ? (UInt)n->arg.inte : n->arg.uint);
+            ret.limit = std::max(ret.limit, ix + 1);
+        }
+    }
+}
+
+// A 'cut' result that is stored in a variable and only ever indexed with
+// constants is split no further than the largest of them, with one scan.
+void lazy_cut_limit(std::vector<Command>& commands, size_t var) {
+
+    cut_uses uses{nullptr, 0, 0, true, 0};
+
+    find_cut_uses(commands, var, uses);
+
+    // A variable bound by a generator has no 'VAW' to rewrite.
+    if (uses.writes != 1 || !uses.write_code || !uses.only_indexed || uses.limit == 0)
+        return;
+
+    std::vector<Command>& code = *uses.write_code;
+    size_t i = uses.write;
+
+    if (i == 0 || !is_full_cut(code, i - 1))
+        return;
+
+    Type args(Type::TUP, { Type(Type::STRING), Type(Type::STRING), Type(Type::UINT) });
+
+    Command& tup = code[i - 2];
+    tup.arg = Atom(UInt(3));
+    tup.type = args;
+
+    set_call(code[i - 1], "__cut_limit", args);
+
+    Command limit(Command::VAL, uses.limit);
+    limit.type = Type(Type::UINT);
+
+    code.insert(code.begin() + i - 2, limit);
+}
+
+// Counts the writes to each variable; 'fixed' is whether a write is in the
+// top-level code, which only runs once.
+void find_writes(const std::vector<Command>& commands, bool top, std::vector<size_t>& writes, std::vector<bool>& fixed) {
+
+    for (const auto& cmd : commands) {
+
+        for (const auto& j : cmd.closure) {
+            find_writes(j.code, false, writes, fixed);
+        }
+
+        if (cmd.cmd != Command::VAW && cmd.cmd != Command::GEN && cmd.cmd != Command::GEN_TRY && cmd.cmd != Command::REC)
+            continue;
+
+        if (cmd.arg.which != Atom::UINT || cmd.arg.uint >= writes.size())
+            continue;
+
+        writes[cmd.arg.uint]++;
+        fixed[cmd.arg.uint] = (top && cmd.cmd == Command::VAW);
+    }
+}
+
+// 'findif(s, p)' and 'findall(s, p)' compare the patterns with the previous
+// call's to see if they need compiling again. When 'p' is a variable that is
+// only assigned once, in the top-level code, they become '__findif_fixed'
+// and '__findall_fixed', which skip the comparison.
+void fixed_patterns(std::vector<Command>& commands, const std::vector<bool>& fixed) {
+
+    static const Type args(Type::TUP, { Type(Type::STRING), Type(Type::ARR, { Type(Type::STRING) }) });
+
+    for (auto& cmd : commands) {
+        for (auto& j : cmd.closure) {
+            fixed_patterns(j.code, fixed);
+        }
+    }
+
+    for (size_t i = 2; i < commands.size(); ++i) {
+
+        const Command& p = commands[i - 2];
+        const Command& tup = commands[i - 1];
+
+        if (p.cmd != Command::VAR || p.arg.which != Atom::UINT || p.arg.uint >= fixed.size() || !fixed[p.arg.uint] ||
+            tup.cmd != Command::TUP || tup.type != args)
+            continue;
+
+        if (is_call(commands[i], "findif")) {
+            set_call(commands[i], "__findif_fixed", args);
+
+        } else if (is_call(commands[i], "findall")) {
+            set_call(commands[i], "__findall_fixed", args);
+        }
+    }
+}
+
 }
 
 #include <iostream>
@@ -88,6 +295,23 @@ void optimize(std::vector<Command>& commands, const TypeRuntime& typer) {
             remove_variable(commands, var);
         }
     }
+
+    lazy_cut_index(commands);
+
+    for (size_t var = 0; var < typer.num_vars(); ++var) {
+        lazy_cut_limit(commands, var);
+    }
+
+    std::vector<size_t> writes(typer.num_vars(), 0);
+    std::vector<bool> fixed(typer.num_vars(), false);
+
+    find_writes(commands, true, writes, fixed);
+
+    for (size_t var = 0; var < fixed.size(); ++var) {
+        fixed[var] = (fixed[var] && writes[var] == 1);
+    }
+
+    fixed_patterns(commands, fixed);
 }
 
 }
@@ -0,0 +1,1291 @@
+#ifndef __TAB_REGEX_H
+#define __TAB_REGEX_H
+
+// Regular expressions for 'grep', 'grepif', 'replace' and 'recut'.
+//
+// Patterns that stay within the commonly used part of the ECMAScript
+// syntax (literals, '.', classes, the '\d\w\s' escapes, groups,
+// alternation, greedy and lazy quantifiers, '^' and '$') are compiled
+// into a Thompson NFA. Asking whether a string matches at all runs a DFA
+// that is built lazily from the NFA, one state at a time, as the input
+// needs it; finding where matches and their groups are runs the NFA
+// directly (a Pike VM). Both are linear in the length of the input.
+//
+// Anything else (backreferences, lookahead, '\b', POSIX classes, captures
+// inside repeated groups, ...) is handed to std::regex, which also
+// reports the errors for malformed patterns.
+//
+// The results are the same as std::regex with the default ECMAScript
+// grammar: leftmost match, alternatives and quantifiers tried in order
+// of preference, '.' doesn't match '\n' or '\r'.
+//
+// Either way, the longest literal string that every match has to contain
+// is looked for first, with a plain substring search; most lines in a
+// selective filter are rejected without running the regex at all.
+
+namespace tab {
+
+namespace regex {
+
+struct CharSet {
+    uint64_t bits[4];
+
+    CharSet() : bits{0, 0, 0, 0} {}
+
+    bool has(unsigned char c) const {
+        return (bits[c >> 6] >> (c & 63)) & 1;
+    }
+
+    void add(unsigned char c) {
+        bits[c >> 6] |= ((uint64_t)1 << (c & 63));
+    }
+
+    void add(unsigned char lo, unsigned char hi) {
+        for (unsigned int c = lo; c <= hi; ++c) {
+            add(c);
+        }
+    }
+
+    void add(const CharSet& s) {
+        for (int i = 0; i < 4; ++i) {
+            bits[i] |= s.bits[i];
+        }
+    }
+
+    void invert() {
+        for (int i = 0; i < 4; ++i) {
+            bits[i] = ~bits[i];
+        }
+    }
+
+    // True if exactly one byte is in the set.
+    bool single(unsigned char& c) const {
+
+        int n = 0;
+
+        for (int i = 0; i < 4; ++i) {
+            n += __builtin_popcountll(bits[i]);
+
+            if (bits[i])
+                c = i * 64 + __builtin_ctzll(bits[i]);
+        }
+
+        return (n == 1);
+    }
+};
+
+inline bool is_word(unsigned char c) {
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_');
+}
+
+struct Inst {
+
+    enum op_t {
+        SET,
+        MATCH,
+        JMP,
+        SPLIT,
+        SAVE,
+        BOL,
+        EOL
+    };
+
+    op_t op;
+
+    // SET: index of the char set; JMP, SPLIT: the (preferred) target;
+    // SAVE: the capture slot.
+    uint32_t x;
+
+    // SPLIT: the other target.
+    uint32_t y;
+};
+
+struct Node {
+
+    enum type_t {
+        EMPTY,
+        SET,
+        CAT,
+        ALT,
+        REPEAT,
+        GROUP,
+        ASSERT,
+        WORDB
+    };
+
+    type_t type;
+    std::vector<Node> kids;
+
+    // SET: the char set; GROUP: the group number; ASSERT: the 'Inst::op_t'.
+    uint32_t arg;
+
+    // REPEAT: max < 0 means no upper bound.
+    int min;
+    int max;
+    bool greedy;
+
+    Node(type_t t = EMPTY, uint32_t a = 0) : type(t), arg(a), min(0), max(0), greedy(true) {}
+};
+
+// Thrown for syntax that is left to std::regex.
+struct Unsupported {};
+
+struct Parser {
+
+    const char* i;
+    const char* e;
+
+    std::vector<CharSet>& sets;
+    uint32_t ngroups;
+
+    Parser(const std::string& s, std::vector<CharSet>& cs) :
+        i(s.data()), e(s.data() + s.size()), sets(cs), ngroups(0) {}
+
+    uint32_t add_set(const CharSet& s) {
+        sets.push_back(s);
+        return sets.size() - 1;
+    }
+
+    static CharSet digits() {
+        CharSet s;
+        s.add('0', '9');
+        return s;
+    }
+
+    static CharSet words() {
+        CharSet s;
+        for (unsigned int c = 0; c < 256; ++c) {
+            if (is_word(c))
+                s.add(c);
+        }
+        return s;
+    }
+
+    static CharSet spaces() {
+        CharSet s;
+        s.add(' ');
+        s.add('\t', '\r');
+        return s;
+    }
+
+    static int hex(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        throw Unsupported();
+    }
+
+    // Escapes that mean a single char, in or out of a class.
+    bool char_escape(char c, unsigned char& out) {
+
+        switch (c) {
+        case 't': out = '\t'; return true;
+        case 'n': out = '\n'; return true;
+        case 'v': out = '\v'; return true;
+        case 'f': out = '\f'; return true;
+        case 'r': out = '\r'; return true;
+
+        case '0':
+            if (i != e && *i >= '0' && *i <= '9')
+                throw Unsupported();
+            out = 0;
+            return true;
+
+        case 'x':
+            if (e - i < 2)
+                throw Unsupported();
+            out = hex(i[0]) * 16 + hex(i[1]);
+            i += 2;
+            return true;
+        }
+
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            (unsigned char)c >= 0x80)
+            return false;
+
+        out = c;
+        return true;
+    }
+
+    bool class_escape(char c, CharSet& out) {
+
+        switch (c) {
+        case 'd': out = digits(); break;
+        case 'w': out = words(); break;
+        case 's': out = spaces(); break;
+        case 'D': out = digits(); out.invert(); break;
+        case 'W': out = words(); out.invert(); break;
+        case 'S': out = spaces(); out.invert(); break;
+        default:
+            return false;
+        }
+
+        return true;
+    }
+
+    Node parse() {
+
+        Node ret = alt();
+
+        if (i != e)
+            throw Unsupported();
+
+        return ret;
+    }
+
+    Node alt() {
+
+        Node ret(Node::ALT);
+        ret.kids.push_back(cat());
+
+        while (i != e && *i == '|') {
+            ++i;
+            ret.kids.push_back(cat());
+        }
+
+        if (ret.kids.size() == 1) {
+            Node tmp;
+            std::swap(tmp, ret.kids[0]);
+            return tmp;
+        }
+
+        return ret;
+    }
+
+    Node cat() {
+
+        Node ret(Node::CAT);
+
+        while (i != e && *i != '|' && *i != ')') {
+            ret.kids.push_back(repeat());
+        }
+
+        return ret;
+    }
+
+    bool number(int& out) {
+
+        if (i == e || *i < '0' || *i > '9')
+            return false;
+
+        out = 0;
+
+        while (i != e && *i >= '0' && *i <= '9') {
+            out = out * 10 + (*i - '0');
+            ++i;
+
+            if (out > 1000)
+                throw Unsupported();
+        }
+
+        return true;
+    }
+
+    Node repeat() {
+
+        Node atom = this->atom();
+
+        if (i == e)
+            return atom;
+
+        int min;
+        int max;
+
+        switch (*i) {
+        case '*': min = 0; max = -1; ++i; break;
+        case '+': min = 1; max = -1; ++i; break;
+        case '?': min = 0; max = 1; ++i; break;
+
+        case '{':
+            ++i;
+
+            if (!number(min))
+                throw Unsupported();
+
+            max = min;
+
+            if (i != e && *i == ',') {
+                ++i;
+
+                if (!number(max))
+                    max = -1;
+            }
+
+            if (i == e || *i != '}' || (max >= 0 && max < min))
+                throw Unsupported();
+
+            ++i;
+            break;
+
+        default:
+            return atom;
+        }
+
+        if (atom.type == Node::ASSERT || atom.type == Node::WORDB || atom.type == Node::EMPTY)
+            throw Unsupported();
+
+        Node ret(Node::REPEAT);
+        ret.min = min;
+        ret.max = max;
+
+        if (i != e && *i == '?') {
+            ret.greedy = false;
+            ++i;
+        }
+
+        if (i != e && (*i == '*' || *i == '+' || *i == '?' || *i == '{'))
+            throw Unsupported();
+
+        ret.kids.push_back(atom);
+        return ret;
+    }
+
+    Node atom() {
+
+        char c = *i;
+        ++i;
+
+        switch (c) {
+
+        case '(':
+        {
+            Node ret;
+
+            if (i != e && *i == '?') {
+
+                if (e - i < 2 || i[1] != ':')
+                    throw Unsupported();
+
+                i += 2;
+                ret = alt();
+
+            } else {
+
+                ret = Node(Node::GROUP, ++ngroups);
+                ret.kids.push_back(alt());
+            }
+
+            if (i == e || *i != ')')
+                throw Unsupported();
+
+            ++i;
+            return ret;
+        }
+
+        case '.':
+        {
+            CharSet s;
+            s.add(0, 255);
+            s.bits['\n' >> 6] &= ~((uint64_t)1 << '\n');
+            s.bits['\r' >> 6] &= ~((uint64_t)1 << '\r');
+            return Node(Node::SET, add_set(s));
+        }
+
+        case '[':
+            return Node(Node::SET, add_set(char_class()));
+
+        case '^':
+            return Node(Node::ASSERT, Inst::BOL);
+
+        case '$':
+            return Node(Node::ASSERT, Inst::EOL);
+
+        case '\\':
+        {
+            if (i == e)
+                throw Unsupported();
+
+            c = *i;
+            ++i;
+
+            // Only parsed for the sake of 'required()'.
+            if (c == 'b' || c == 'B')
+                return Node(Node::WORDB);
+
+            CharSet s;
+            unsigned char x;
+
+            if (!class_escape(c, s)) {
+
+                if (!char_escape(c, x))
+                    throw Unsupported();
+
+                s.add(x);
+            }
+
+            return Node(Node::SET, add_set(s));
+        }
+
+        case ')':
+        case ']':
+        case '{':
+        case '}':
+        case '*':
+        case '+':
+        case '?':
+            throw Unsupported();
+
+        default:
+        {
+            CharSet s;
+            s.add(c);
+            return Node(Node::SET, add_set(s));
+        }
+        }
+    }
+
+    // One char of a class, or a class escape like '\d'.
+    bool class_atom(unsigned char& ch, CharSet& cls) {
+
+        char c = *i;
+        ++i;
+
+        if (c == '[' && i != e && (*i == ':' || *i == '.' || *i == '='))
+            throw Unsupported();
+
+        if (c != '\\') {
+            ch = c;
+            return true;
+        }
+
+        if (i == e)
+            throw Unsupported();
+
+        c = *i;
+        ++i;
+
+        if (class_escape(c, cls))
+            return false;
+
+        if (c == 'b' || !char_escape(c, ch))
+            throw Unsupported();
+
+        return true;
+    }
+
+    CharSet char_class() {
+
+        CharSet ret;
+        bool negate = false;
+
+        if (i != e && *i == '^') {
+            negate = true;
+            ++i;
+        }
+
+        if (i == e || *i == ']')
+            throw Unsupported();
+
+        while (1) {
+
+            if (i == e)
+                throw Unsupported();
+
+            if (*i == ']') {
+                ++i;
+                break;
+            }
+
+            unsigned char lo;
+            CharSet cls;
+
+            if (!class_atom(lo, cls)) {
+
+                if (e - i >= 2 && *i == '-' && i[1] != ']')
+                    throw Unsupported();
+
+                ret.add(cls);
+                continue;
+            }
+
+            if (e - i >= 2 && *i == '-' && i[1] != ']') {
+                ++i;
+
+                unsigned char hi;
+
+                if (!class_atom(hi, cls) || hi < lo || lo >= 0x80 || hi >= 0x80)
+                    throw Unsupported();
+
+                ret.add(lo, hi);
+
+            } else {
+                ret.add(lo);
+            }
+        }
+
+        if (negate)
+            ret.invert();
+
+        return ret;
+    }
+};
+
+struct Program {
+
+    std::vector<Inst> code;
+    std::vector<CharSet> sets;
+
+    // Two per group, and two for the whole match.
+    uint32_t nslots;
+
+    // A string that every match contains.
+    std::string literal;
+
+    // The bytes a match can start with; if the pattern can't match an
+    // empty string, the search can skip ahead to one of them.
+    CharSet first;
+    bool skip;
+
+    static const size_t MAX_SIZE = 20000;
+
+    uint32_t emit(Inst::op_t op, uint32_t x = 0, uint32_t y = 0) {
+
+        if (code.size() >= MAX_SIZE)
+            throw Unsupported();
+
+        code.push_back(Inst{op, x, y});
+        return code.size() - 1;
+    }
+
+    void compile(const Node& n, bool repeated) {
+
+        switch (n.type) {
+
+        case Node::EMPTY:
+            break;
+
+        case Node::SET:
+            emit(Inst::SET, n.arg);
+            break;
+
+        case Node::CAT:
+            for (const Node& k : n.kids) {
+                compile(k, repeated);
+            }
+            break;
+
+        case Node::ALT:
+        {
+            std::vector<uint32_t> jumps;
+
+            for (size_t k = 0; k < n.kids.size(); ++k) {
+
+                uint32_t split = 0;
+
+                if (k + 1 < n.kids.size())
+                    split = emit(Inst::SPLIT, code.size() + 1);
+
+                compile(n.kids[k], repeated);
+
+                if (k + 1 < n.kids.size()) {
+                    jumps.push_back(emit(Inst::JMP));
+                    code[split].y = code.size();
+                }
+            }
+
+            for (uint32_t j : jumps) {
+                code[j].x = code.size();
+            }
+            break;
+        }
+
+        case Node::GROUP:
+            // std::regex forgets the groups of earlier iterations; we don't.
+            if (repeated)
+                throw Unsupported();
+
+            emit(Inst::SAVE, n.arg * 2);
+            compile(n.kids[0], repeated);
+            emit(Inst::SAVE, n.arg * 2 + 1);
+            break;
+
+        case Node::ASSERT:
+            emit((Inst::op_t)n.arg);
+            break;
+
+        case Node::WORDB:
+            throw Unsupported();
+
+        case Node::REPEAT:
+        {
+            const Node& k = n.kids[0];
+            bool rep = repeated || n.max < 0 || n.max > 1;
+
+            // Which of the ways to go around a loop without consuming
+            // anything std::regex prefers can't be followed in an NFA.
+            if (rep && nullable(k))
+                throw Unsupported();
+
+            for (int j = 0; j < n.min; ++j) {
+                compile(k, rep);
+            }
+
+            if (n.max < 0) {
+
+                uint32_t split = emit(Inst::SPLIT);
+                compile(k, rep);
+                emit(Inst::JMP, split);
+                set_split(split, split + 1, code.size(), n.greedy);
+
+            } else {
+
+                std::vector<uint32_t> splits;
+
+                for (int j = n.min; j < n.max; ++j) {
+                    splits.push_back(emit(Inst::SPLIT));
+                    compile(k, rep);
+                }
+
+                for (uint32_t s : splits) {
+                    set_split(s, s + 1, code.size(), n.greedy);
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    // Returns false if 'MATCH' can be reached without consuming anything.
+    bool first_set(uint32_t pc, std::vector<bool>& seen) {
+
+        if (seen[pc])
+            return true;
+
+        seen[pc] = true;
+
+        const Inst& in = code[pc];
+
+        switch (in.op) {
+        case Inst::SET:
+            first.add(sets[in.x]);
+            return true;
+
+        case Inst::MATCH:
+            return false;
+
+        case Inst::JMP:
+            return first_set(in.x, seen);
+
+        case Inst::SPLIT:
+        {
+            bool a = first_set(in.x, seen);
+            bool b = first_set(in.y, seen);
+            return (a && b);
+        }
+
+        default:
+            return first_set(pc + 1, seen);
+        }
+    }
+
+    // The longest literal string in every match of 'n'; 'exact' if 'n'
+    // matches nothing but that string.
+    void required(const Node& n, std::string& lit, bool& exact) const {
+
+        lit.clear();
+        exact = false;
+
+        switch (n.type) {
+
+        case Node::EMPTY:
+        case Node::ASSERT:
+        case Node::WORDB:
+            exact = true;
+            break;
+
+        case Node::SET:
+        {
+            unsigned char c = 0;
+
+            if (sets[n.arg].single(c)) {
+                lit.assign(1, c);
+                exact = true;
+            }
+            break;
+        }
+
+        case Node::GROUP:
+            required(n.kids[0], lit, exact);
+            break;
+
+        case Node::REPEAT:
+            if (n.min > 0) {
+                required(n.kids[0], lit, exact);
+                exact = (exact && n.min == 1 && n.max == 1);
+            }
+            break;
+
+        case Node::CAT:
+        {
+            std::string run;
+            std::string k;
+            bool kx;
+
+            exact = true;
+
+            for (const Node& kid : n.kids) {
+
+                required(kid, k, kx);
+
+                if (kx) {
+                    run += k;
+                    continue;
+                }
+
+                exact = false;
+
+                if (run.size() > lit.size())
+                    lit = run;
+
+                if (k.size() > lit.size())
+                    lit = k;
+
+                run.clear();
+            }
+
+            if (run.size() > lit.size())
+                lit = run;
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    static bool nullable(const Node& n) {
+
+        switch (n.type) {
+        case Node::SET:
+            return false;
+
+        case Node::CAT:
+            for (const Node& k : n.kids) {
+                if (!nullable(k))
+                    return false;
+            }
+            return true;
+
+        case Node::ALT:
+            for (const Node& k : n.kids) {
+                if (nullable(k))
+                    return true;
+            }
+            return false;
+
+        case Node::REPEAT:
+            return (n.min == 0 || nullable(n.kids[0]));
+
+        case Node::GROUP:
+            return nullable(n.kids[0]);
+
+        default:
+            return true;
+        }
+    }
+
+    void set_split(uint32_t s, uint32_t body, uint32_t out, bool greedy) {
+        code[s].x = (greedy ? body : out);
+        code[s].y = (greedy ? out : body);
+    }
+
+    // Returns false if the pattern has to go to std::regex.
+    bool compile(const std::string& pattern) {
+
+        try {
+            Parser parser(pattern, sets);
+            Node root = parser.parse();
+
+            bool exact;
+            required(root, literal, exact);
+
+            nslots = (parser.ngroups + 1) * 2;
+
+            emit(Inst::SAVE, 0);
+            compile(root, false);
+            emit(Inst::SAVE, 1);
+            emit(Inst::MATCH);
+
+            std::vector<bool> seen(code.size());
+            skip = first_set(0, seen);
+
+        } catch (Unsupported& u) {
+            return false;
+        }
+
+        return true;
+    }
+
+};
+
+// The NFA simulation; threads are kept in order of preference, and a
+// thread that reaches 'MATCH' cuts off all threads after it.
+struct PikeVM {
+
+    struct Threads {
+        std::vector<uint32_t> sparse;
+        std::vector<uint32_t> dense;
+        size_t n;
+
+        // 'nslots' capture pointers for every 'pc'.
+        std::vector<const char*> caps;
+
+        void init(size_t size, size_t nslots) {
+            sparse.resize(size);
+            dense.resize(size);
+            caps.resize(size * nslots);
+            n = 0;
+        }
+
+        bool has(uint32_t pc) const {
+            uint32_t j = sparse[pc];
+            return (j < n && dense[j] == pc);
+        }
+
+        void insert(uint32_t pc) {
+            sparse[pc] = n;
+            dense[n] = pc;
+            ++n;
+        }
+    };
+
+    const Program& prog;
+    Threads clist;
+    Threads nlist;
+    std::vector<const char*> tmp;
+
+    const char* b;
+    const char* e;
+
+    PikeVM(const Program& p) : prog(p), b(nullptr), e(nullptr) {
+        clist.init(prog.code.size(), prog.nslots);
+        nlist.init(prog.code.size(), prog.nslots);
+        tmp.resize(prog.nslots);
+    }
+
+    void add(Threads& t, uint32_t pc, const char* p, const char** cap) {
+
+        if (t.has(pc))
+            return;
+
+        t.insert(pc);
+
+        const Inst& in = prog.code[pc];
+
+        switch (in.op) {
+
+        case Inst::JMP:
+            add(t, in.x, p, cap);
+            break;
+
+        case Inst::SPLIT:
+            add(t, in.x, p, cap);
+            add(t, in.y, p, cap);
+            break;
+
+        case Inst::SAVE:
+        {
+            const char* old = cap[in.x];
+            cap[in.x] = p;
+            add(t, pc + 1, p, cap);
+            cap[in.x] = old;
+            break;
+        }
+
+        case Inst::BOL:
+            if (p == b)
+                add(t, pc + 1, p, cap);
+            break;
+
+        case Inst::EOL:
+            if (p == e)
+                add(t, pc + 1, p, cap);
+            break;
+
+        default:
+            std::copy(cap, cap + prog.nslots, &t.caps[pc * prog.nslots]);
+            break;
+        }
+    }
+
+    // Finds the leftmost match starting at or after 'from' ('b' is where the
+    // string starts, for '^'). 'out' gets 'nslots' pointers; unmatched
+    // groups are nullptr.
+    bool find(const char* _b, const char* from, const char* _e, const char** out,
+              bool continuous, bool not_null) {
+
+        b = _b;
+        e = _e;
+
+        const size_t nslots = prog.nslots;
+        bool matched = false;
+
+        clist.n = 0;
+
+        for (const char* p = from; ; ++p) {
+
+            if (clist.n == 0 && !matched && !continuous && prog.skip) {
+
+                while (p != e && !prog.first.has(*p)) {
+                    ++p;
+                }
+
+                if (p == e)
+                    break;
+            }
+
+            if (!matched && (!continuous || p == from)) {
+                std::fill(tmp.begin(), tmp.end(), nullptr);
+                add(clist, 0, p, tmp.data());
+            }
+
+            nlist.n = 0;
+
+            for (size_t j = 0; j < clist.n; ++j) {
+
+                uint32_t pc = clist.dense[j];
+                const Inst& in = prog.code[pc];
+                const char** cap = &clist.caps[pc * nslots];
+
+                if (in.op == Inst::SET) {
+
+                    if (p != e && prog.sets[in.x].has(*p))
+                        add(nlist, pc + 1, p + 1, cap);
+
+                } else if (in.op == Inst::MATCH) {
+
+                    if (not_null && cap[0] == p)
+                        continue;
+
+                    std::copy(cap, cap + nslots, out);
+                    matched = true;
+                    break;
+                }
+            }
+
+            std::swap(clist, nlist);
+
+            if (p == e)
+                break;
+
+            if (clist.n == 0 && (matched || continuous))
+                break;
+        }
+
+        return matched;
+    }
+};
+
+// The DFA only answers whether there is a match anywhere. Its states are
+// sets of NFA instructions ('SET', 'MATCH' and pending 'EOL'); transitions
+// are filled in as they are first taken, over classes of bytes that no
+// char set in the program tells apart.
+struct DFA {
+
+    static const size_t MAX_STATES = 4096;
+
+    enum {
+        UNKNOWN = -1
+    };
+
+    enum {
+        MATCH = 1,
+        MATCH_AT_END = 2
+    };
+
+    const Program& prog;
+
+    unsigned char classes[256];
+    std::vector<unsigned char> rep;
+    size_t nclasses;
+
+    std::vector<int32_t> next;
+    std::vector<unsigned char> flags;
+    std::vector< std::vector<uint32_t> > states;
+    std::map< std::vector<uint32_t>, int32_t > index;
+
+    std::vector<uint32_t> stack;
+    std::vector<bool> seen;
+
+    DFA(const Program& p) : prog(p), nclasses(0) {
+
+        seen.resize(prog.code.size());
+
+        for (unsigned int c = 0; c < 256; ++c) {
+
+            bool same = (c > 0);
+
+            for (const CharSet& s : prog.sets) {
+                if (c > 0 && s.has(c) != s.has(c - 1)) {
+                    same = false;
+                    break;
+                }
+            }
+
+            if (!same) {
+                rep.push_back(c);
+                ++nclasses;
+            }
+
+            classes[c] = nclasses - 1;
+        }
+
+        reset();
+    }
+
+    void reset() {
+        next.clear();
+        flags.clear();
+        states.clear();
+        index.clear();
+
+        // State 0 is the start.
+        std::vector<uint32_t> start;
+        stack.push_back(0);
+        closure(true, false, start);
+        start.push_back(0xFFFFFFFF);
+        add_state(start, true);
+    }
+
+    // Everything reachable from the instructions in 'stack' without
+    // consuming a char.
+    void closure(bool at_begin, bool at_end, std::vector<uint32_t>& out) {
+
+        std::fill(seen.begin(), seen.end(), false);
+
+        while (!stack.empty()) {
+
+            uint32_t pc = stack.back();
+            stack.pop_back();
+
+            if (seen[pc])
+                continue;
+
+            seen[pc] = true;
+
+            const Inst& in = prog.code[pc];
+
+            switch (in.op) {
+            case Inst::JMP:
+                stack.push_back(in.x);
+                break;
+
+            case Inst::SPLIT:
+                stack.push_back(in.y);
+                stack.push_back(in.x);
+                break;
+
+            case Inst::SAVE:
+                stack.push_back(pc + 1);
+                break;
+
+            case Inst::BOL:
+                if (at_begin)
+                    stack.push_back(pc + 1);
+                break;
+
+            case Inst::EOL:
+                if (at_end) {
+                    stack.push_back(pc + 1);
+                } else {
+                    out.push_back(pc);
+                }
+                break;
+
+            case Inst::SET:
+            case Inst::MATCH:
+                out.push_back(pc);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    int32_t add_state(std::vector<uint32_t>& set, bool at_begin) {
+
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+
+        auto i = index.find(set);
+
+        if (i != index.end())
+            return i->second;
+
+        unsigned char f = 0;
+        std::vector<uint32_t> tmp;
+
+        for (uint32_t pc : set) {
+
+            if (pc == 0xFFFFFFFF)
+                continue;
+
+            const Inst& in = prog.code[pc];
+
+            if (in.op == Inst::MATCH)
+                f |= (MATCH | MATCH_AT_END);
+
+            if (in.op == Inst::EOL) {
+                tmp.clear();
+                stack.push_back(pc + 1);
+                closure(at_begin, true, tmp);
+
+                for (uint32_t x : tmp) {
+                    if (prog.code[x].op == Inst::MATCH)
+                        f |= MATCH_AT_END;
+                }
+            }
+        }
+
+        int32_t s = states.size();
+
+        states.push_back(set);
+        flags.push_back(f);
+        next.resize(next.size() + nclasses, UNKNOWN);
+        index[set] = s;
+
+        return s;
+    }
+
+    int32_t step(int32_t s, unsigned char c) {
+
+        if (states.size() >= MAX_STATES) {
+            std::vector<uint32_t> set = states[s];
+            reset();
+            s = add_state(set, false);
+        }
+
+        // The search is unanchored, so a new match may start anywhere.
+        stack.push_back(0);
+
+        for (uint32_t pc : states[s]) {
+
+            if (pc == 0xFFFFFFFF)
+                continue;
+
+            const Inst& in = prog.code[pc];
+
+            if (in.op == Inst::SET && prog.sets[in.x].has(rep[c]))
+                stack.push_back(pc + 1);
+        }
+
+        std::vector<uint32_t> set;
+        closure(false, false, set);
+
+        int32_t t = add_state(set, false);
+        next[s * nclasses + c] = t;
+        return t;
+    }
+
+    bool search(const char* b, const char* e) {
+
+        int32_t s = 0;
+
+        if (flags[s] & MATCH)
+            return true;
+
+        for (const char* p = b; p != e; ++p) {
+
+            unsigned char c = classes[(unsigned char)*p];
+            int32_t t = next[s * nclasses + c];
+
+            if (t == UNKNOWN)
+                t = step(s, c);
+
+            s = t;
+
+            if (flags[s] & MATCH)
+                return true;
+        }
+
+        return (flags[s] & MATCH_AT_END);
+    }
+};
+
+struct Regex {
+
+    Program prog;
+    std::unique_ptr<PikeVM> vm;
+    std::unique_ptr<DFA> dfa;
+    std::unique_ptr<std::regex> fallback;
+    std::vector<const char*> caps;
+
+    Regex(const std::string& pattern) {
+
+        if (prog.compile(pattern)) {
+
+            vm.reset(new PikeVM(prog));
+            dfa.reset(new DFA(prog));
+            caps.resize(prog.nslots);
+
+        } else {
+            fallback.reset(new std::regex(pattern, std::regex_constants::optimize));
+        }
+    }
+
+    // The number of capture pointers filled by 'find'.
+    size_t nslots() const {
+        return (fallback ? (fallback->mark_count() + 1) * 2 : prog.nslots);
+    }
+
+    bool maybe(const char* b, const char* e) const {
+
+        const std::string& lit = prog.literal;
+
+        return (lit.empty() || scan::find_str(b, e, lit.data(), lit.size()) != e);
+    }
+
+    bool search(const char* b, const char* e) {
+
+        if (!maybe(b, e))
+            return false;
+
+        if (dfa)
+            return dfa->search(b, e);
+
+        return std::regex_search(b, e, *fallback);
+    }
+
+    // Like 'std::regex_search' from 'from', where the string starts at 'b';
+    // 'continuous' anchors the match at 'from', and 'not_null' rejects empty
+    // matches.
+    bool find(const char* b, const char* from, const char* e, const char** out,
+              bool continuous = false, bool not_null = false) {
+
+        if (!maybe(from, e))
+            return false;
+
+        if (vm)
+            return vm->find(b, from, e, out, continuous, not_null);
+
+        auto f = std::regex_constants::match_default;
+
+        if (from != b)
+            f |= std::regex_constants::match_prev_avail;
+
+        if (continuous)
+            f |= std::regex_constants::match_continuous;
+
+        if (not_null)
+            f |= std::regex_constants::match_not_null;
+
+        std::cmatch m;
+
+        if (!std::regex_search(from, e, m, *fallback, f))
+            return false;
+
+        for (size_t j = 0; j < m.size(); ++j) {
+            out[j * 2] = (m[j].matched ? m[j].first : nullptr);
+            out[j * 2 + 1] = (m[j].matched ? m[j].second : nullptr);
+        }
+
+        return true;
+    }
+};
+
+} // namespace regex
+
+} // namespace tab
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef __TAB_SCAN_H
+#define __TAB_SCAN_H
+
+// Byte search over buffers. Everything that splits input on a delimiter
+// goes through 'find_byte', which picks the widest vector implementation
+// the CPU supports the first time it is called.
+//
+// 'find_str' and 'rfind_str' search for delimiters of any length; longer
+// ones are found by looking for their first and last bytes sixteen
+// positions at a time and only comparing the rest where both match.
+//
+// 'skip_byte' steps over a given number of occurrences of a byte (lines,
+// for 'skip') by counting them a vector at a time.
+
+namespace tab {
+
+namespace scan {
+
+typedef const char* (*find_byte_t)(const char* b, const char* e, char c);
+typedef const char* (*skip_byte_t)(const char* b, const char* e, char c, size_t& n);
+
+const char* find_byte_generic(const char* b, const char* e, char c) {
+
+    const void* r = ::memchr(b, c, e - b);
+    return (r ? (const char*)r : e);
+}
+
+// Returns the position after the 'n'-th occurrence of 'c' and sets 'n' to
+// zero, or returns 'e' and subtracts the number of occurrences from 'n'.
+const char* skip_byte_generic(const char* b, const char* e, char c, size_t& n) {
+
+    while (n > 0) {
+        const void* r = ::memchr(b, c, e - b);
+
+        if (!r)
+            return e;
+
+        b = (const char*)r + 1;
+        --n;
+    }
+
+    return b;
+}
+
+// The position of the 'n'-th (counting from zero) set bit.
+inline unsigned int nth_bit(uint64_t mask, size_t n) {
+
+    for (; n > 0; --n)
+        mask &= mask - 1;
+
+    return __builtin_ctzll(mask);
+}
+
+#if defined(__SSE2__) && defined(__GNUC__)
+
+const char* skip_byte_sse2(const char* b, const char* e, char c, size_t& n) {
+
+    const __m128i needle = _mm_set1_epi8(c);
+
+    while (n > 0 && e - b >= 64) {
+
+        uint64_t mask = 0;
+
+        for (int k = 0; k < 4; ++k) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(b + 16 * k));
+            mask |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, needle)) << (16 * k);
+        }
+
+        size_t found = __builtin_popcountll(mask);
+
+        if (found >= n) {
+            b += nth_bit(mask, n - 1) + 1;
+            n = 0;
+            return b;
+        }
+
+        n -= found;
+        b += 64;
+    }
+
+    return skip_byte_generic(b, e, c, n);
+}
+
+__attribute__((target("avx2,popcnt")))
+const char* skip_byte_avx2(const char* b, const char* e, char c, size_t& n) {
+
+    const __m256i needle = _mm256_set1_epi8(c);
+
+    while (n > 0 && e - b >= 64) {
+
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)b);
+        __m256i x2 = _mm256_loadu_si256((const __m256i*)(b + 32));
+
+        uint64_t mask = (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x1, needle)) |
+            ((uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x2, needle)) << 32);
+
+        size_t found = __builtin_popcountll(mask);
+
+        if (found >= n) {
+            b += nth_bit(mask, n - 1) + 1;
+            n = 0;
+            return b;
+        }
+
+        n -= found;
+        b += 64;
+    }
+
+    return skip_byte_generic(b, e, c, n);
+}
+
+skip_byte_t skip_byte_select() {
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return skip_byte_avx2;
+
+    return skip_byte_sse2;
+}
+
+const char* find_byte_sse2(const char* b, const char* e, char c) {
+
+    const __m128i needle = _mm_set1_epi8(c);
+
+    while (e - b >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)b);
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, needle));
+
+        if (mask != 0)
+            return b + __builtin_ctz(mask);
+
+        b += 16;
+    }
+
+    while (b != e && *b != c)
+        ++b;
+
+    return b;
+}
+
+__attribute__((target("avx2")))
+const char* find_byte_avx2(const char* b, const char* e, char c) {
+
+    const __m256i needle = _mm256_set1_epi8(c);
+
+    while (e - b >= 64) {
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)b);
+        __m256i x2 = _mm256_loadu_si256((const __m256i*)(b + 32));
+        __m256i m1 = _mm256_cmpeq_epi8(x1, needle);
+        __m256i m2 = _mm256_cmpeq_epi8(x2, needle);
+
+        if (!_mm256_testz_si256(_mm256_or_si256(m1, m2), _mm256_or_si256(m1, m2))) {
+
+            unsigned int mask = _mm256_movemask_epi8(m1);
+
+            if (mask != 0)
+                return b + __builtin_ctz(mask);
+
+            return b + 32 + __builtin_ctz((unsigned int)_mm256_movemask_epi8(m2));
+        }
+
+        b += 64;
+    }
+
+    while (e - b >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)b);
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, needle));
+
+        if (mask != 0)
+            return b + __builtin_ctz(mask);
+
+        b += 32;
+    }
+
+    return find_byte_sse2(b, e, c);
+}
+
+find_byte_t find_byte_select() {
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return find_byte_avx2;
+
+    return find_byte_sse2;
+}
+
+#else
+
+find_byte_t find_byte_select() {
+    return find_byte_generic;
+}
+
+skip_byte_t skip_byte_select() {
+    return skip_byte_generic;
+}
+
+#endif
+
+const char* find_byte(const char* b, const char* e, char c) {
+
+    static const find_byte_t impl = find_byte_select();
+
+    return impl(b, e, c);
+}
+
+const char* skip_byte(const char* b, const char* e, char c, size_t& n) {
+
+    static const skip_byte_t impl = skip_byte_select();
+
+    return impl(b, e, c, n);
+}
+
+// Returns 'e' if not found.
+inline const char* find_str(const char* b, const char* e, const char* n, size_t m) {
+
+    if (m == 0)
+        return b;
+
+    if ((size_t)(e - b) < m)
+        return e;
+
+    // Positions where a match could start.
+    const char* stop = e - m + 1;
+
+    // Fields are usually short; look at the first few bytes directly
+    // before paying for a vector search.
+    const char* near = (stop - b > 16 ? b + 16 : stop);
+
+    const char c = n[0];
+
+    for (; b != near; ++b) {
+        if (*b == c && (m == 1 || ::memcmp(b + 1, n + 1, m - 1) == 0))
+            return b;
+    }
+
+    if (b == stop)
+        return e;
+
+    if (m == 1)
+        return find_byte(b, e, c);
+
+#if defined(__SSE2__) && defined(__GNUC__)
+
+    const __m128i first = _mm_set1_epi8(n[0]);
+    const __m128i last = _mm_set1_epi8(n[m - 1]);
+
+    while (stop - b >= 16) {
+        __m128i xf = _mm_loadu_si128((const __m128i*)b);
+        __m128i xl = _mm_loadu_si128((const __m128i*)(b + m - 1));
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(xf, first), _mm_cmpeq_epi8(xl, last)));
+
+        while (mask != 0) {
+            const char* i = b + __builtin_ctz(mask);
+
+            if (::memcmp(i + 1, n + 1, m - 2) == 0)
+                return i;
+
+            mask &= mask - 1;
+        }
+
+        b += 16;
+    }
+
+#endif
+
+    while (b != stop) {
+
+        b = find_byte(b, stop, n[0]);
+
+        if (b == stop)
+            break;
+
+        if (::memcmp(b + 1, n + 1, m - 1) == 0)
+            return b;
+
+        ++b;
+    }
+
+    return e;
+}
+
+// Returns the start of the last match, or nullptr if not found.
+const char* rfind_str(const char* b, const char* e, const char* n, size_t m) {
+
+    if (m == 0)
+        return e;
+
+    while ((size_t)(e - b) >= m) {
+
+        const char* i = (const char*)::memrchr(b + m - 1, n[m - 1], e - b - m + 1);
+
+        if (!i)
+            return nullptr;
+
+        i -= (m - 1);
+
+        if (::memcmp(i, n, m - 1) == 0)
+            return i;
+
+        e = i + m - 1;
+    }
+
+    return nullptr;
+}
+
+}
+
+}
+
+#endif
@@ -4,21 +4,6 @@
 #include "tab.h"
 
 
-std::istream& file_or_stdin(const std::string& file) {
-
-    if (file.empty())
-        return std::cin;
-
-    static std::ifstream ret;
-
-    ret.open(file);
-
-    if (!ret)
-        throw std::runtime_error("Could not open input file: " + file);
-
-    return ret;
-}
-
 #ifdef _REENTRANT
 #include "threaded.h"
 #endif
@@ -36,7 +21,7 @@ void run(size_t seed, const std::string& program, const std::string& infile, uns
     typename tab::API<SORTED>::compiled_t code;
     api.compile(program.begin(), program.end(), intype, code, debuglevel);
 
-    tab::obj::Object* input = new tab::funcs::SeqFile(file_or_stdin(infile));
+    tab::obj::Object* input = new tab::funcs::SeqFile(infile);
     tab::obj::Object* output = api.run(code, input);
 
     tab::obj::Printer p;
@@ -58,7 +43,7 @@ void show_help(const std::string& help_section) {
     }
 
     std::cout <<
-        "Usage: tab [-i inputdata_file] [-f expression_file] [-t N] [-r random seed] [-s] [-v|-vv|-vvv] [-h section] "
+        "Usage: tab [-i inputdata_file] [-f expression_file] [-t N] [-r random seed] [-s] [-R] [-v|-vv|-vvv] [-h section] "
               << "<expressions...>"
               << std::endl
               << "  -V, --version:   show version." << std::endl
@@ -67,6 +52,7 @@ void show_help(const std::string& help_section) {
               << "  -p:   use this code as the prelude; this code will be prepended to code from file and command line args." << std::endl
               << "  -r:   use a specific random seed." << std::endl
               << "  -s:   use maps with keys in sorted order instead of the unsorted default." << std::endl
+              << "  -R:   print real numbers with all the digits needed to read them back exactly." << std::endl
 #ifdef _REENTRANT
               << "  -t:   use N parallel threads for evaluating the expression." << std::endl
 #endif
@@ -161,6 +147,10 @@ int main(int argc, char** argv) {
 
                 sorted = true;
 
+            } else if (arg == "-R") {
+
+                tab::obj::print_roundtrip_reals() = true;
+
             } else if (getopt('p', argc, argv, i, prelude)) {
 
             } else if (getopt('f', argc, argv, i, programfile)) {
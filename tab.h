@@ -10,6 +10,11 @@
 #include "optimize.h"
 #include "parse.h"
 #include "hash.h"
+#include "scan.h"
+#include "number.h"
+#include "regex.h"
+#include "multifind.h"
+#include "flatmap.h"
 #include "object.h"
 #include "funcs.h"
 #include "exec.h"
@@ -0,0 +1,70 @@
+import sys
+import os
+import random
+import subprocess
+import time
+
+# Usage: python3 bench.py [input file] [size in Mb]
+#
+# Reports input throughput for a plain line scan and for splitting lines
+# with 'cut'. The input files are generated if they do not exist; the
+# 'cut' benchmarks run over 'temps.tsv' repeated up to the same size.
+
+def generate(filename, size):
+    rnd = random.Random(1234)
+    words = [ ''.join(rnd.choice('abcdefghijklmnopqrstuvwxyz') for _ in range(rnd.randint(2, 12)))
+              for _ in range(1000) ]
+
+    with open(filename, 'w') as f:
+        written = 0
+        while written < size:
+            line = '\t'.join(rnd.choice(words) for _ in range(rnd.randint(1, 20))) + '\n'
+            f.write(line)
+            written += len(line)
+
+def generate_temps(filename, size):
+    with open("temps.tsv") as f:
+        lines = f.read()
+
+    with open(filename, 'w') as f:
+        written = 0
+        while written < size:
+            f.write(lines)
+            written += len(lines)
+
+def bench(filename, program, runs=5):
+    best = None
+    for _ in range(runs):
+        t = time.time()
+        subprocess.check_output(["../tab", "-i", filename, program])
+        t = time.time() - t
+        if best is None or t < best:
+            best = t
+    return best
+
+def go():
+    filename = sys.argv[1] if len(sys.argv) > 1 else "/tmp/tab-bench.txt"
+    size = int(sys.argv[2]) if len(sys.argv) > 2 else 512
+
+    if not os.path.exists(filename):
+        print("Generating %d Mb of input in %s" % (size, filename))
+        generate(filename, size * 1024 * 1024)
+
+    temps = os.path.splitext(filename)[0] + "-temps.tsv"
+
+    if not os.path.exists(temps):
+        print("Generating %d Mb of input in %s" % (size, temps))
+        generate_temps(temps, size * 1024 * 1024)
+
+    benches = [ (filename, "count.@"),
+                (temps, 'sum.[count(cut(@,"\\t"))]'),
+                (temps, 'sum.[int(cut(@,"\\t",3))]'),
+                (temps, 'sum.[int(cut(@,"\\t",-1))]'),
+                (temps, 'sum.[count(cut(@,"2\\t"))]') ]
+
+    for f, program in benches:
+        nbytes = os.path.getsize(f)
+        t = bench(f, program)
+        print("%-30s %8.3f sec  %6.2f Gb/s" % (program, t, nbytes / t / 1e9))
+
+go()
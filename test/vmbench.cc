@@ -0,0 +1,125 @@
+
+// Usage: vmbench <test files...>
+//
+// Runs the programs from the given test case files in a loop and reports
+// the time per executed VM instruction. Must be built with -DTAB_VM_STATS;
+// build it again with -DTAB_NO_COMPUTED_GOTO to compare dispatch methods.
+// (See 'make vmbench'.)
+
+#include <chrono>
+
+#include "../tab.h"
+
+struct testcase_t {
+    std::string name;
+    std::string program;
+    std::string infile;
+};
+
+bool load(const std::string& name, testcase_t& out) {
+
+    std::ifstream f(name);
+    std::string txt((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    std::vector<std::string> parts;
+    const std::string sep = "===>\n";
+    size_t i = 0;
+
+    while (1) {
+        size_t j = txt.find(sep, i);
+
+        if (j == std::string::npos) {
+            parts.push_back(txt.substr(i));
+            break;
+        }
+
+        parts.push_back(txt.substr(i, j - i));
+        i = j + sep.size();
+    }
+
+    out.name = name;
+    out.infile = "../LICENSE.txt";
+
+    if (parts.size() == 3) {
+        out.infile = parts[0];
+        out.infile.erase(std::remove(out.infile.begin(), out.infile.end(), '\n'), out.infile.end());
+        out.program = parts[1];
+
+    } else if (parts.size() == 2) {
+        out.program = parts[0];
+
+    } else {
+        // Error test cases.
+        return false;
+    }
+
+    // Multithreaded programs.
+    if (out.program.find("-->") != std::string::npos)
+        return false;
+
+    out.program = "def $ index.@," + out.program;
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    typedef tab::API<false> api_t;
+    typedef std::chrono::steady_clock clock_t;
+
+    api_t::init(1234);
+
+    uint64_t total_ninstr = 0;
+    double total_ns = 0;
+
+    for (int i = 1; i < argc; ++i) {
+
+        testcase_t test;
+
+        if (!load(argv[i], test))
+            continue;
+
+        try {
+            api_t::compiled_t code;
+            api_t::compile(test.program.begin(), test.program.end(),
+                           tab::Type(tab::Type::SEQ, { tab::Type(tab::Type::STRING) }), code);
+
+            uint64_t ninstr = 0;
+            size_t nruns = 0;
+            auto start = clock_t::now();
+            std::chrono::duration<double, std::nano> elapsed;
+
+            do {
+                tab::obj::Object* input = new tab::funcs::SeqFile(test.infile);
+
+                tab::vm_instructions() = 0;
+                api_t::run(code, input);
+                ninstr += tab::vm_instructions();
+                ++nruns;
+
+                delete input;
+                elapsed = clock_t::now() - start;
+
+            } while (elapsed.count() < 50e6);
+
+            total_ninstr += ninstr;
+            total_ns += elapsed.count();
+
+            printf("%-32s %10.1f instr/run %8.2f ns/instr\n", test.name.c_str(),
+                   (double)ninstr / nruns, elapsed.count() / ninstr);
+
+        } catch (std::exception& e) {
+            printf("%-32s skipped: %s\n", test.name.c_str(), e.what());
+        }
+    }
+
+#ifdef TAB_COMPUTED_GOTO
+    const char* dispatch = "computed goto";
+#else
+    const char* dispatch = "switch";
+#endif
+
+    printf("Total (%s): %llu instructions, %.2f ns/instr\n", dispatch,
+           (unsigned long long)total_ninstr, total_ns / total_ninstr);
+
+    return 0;
+}
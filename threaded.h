@@ -4,81 +4,324 @@
 #include <mutex>
 #include <condition_variable>
 #include <memory>
+#include <atomic>
 
 namespace tab {
 
+// Input shared by all scatter threads.
+//
+// A memory-mapped file is split into CHUNK-sized byte ranges that threads
+// claim with an atomic counter; a line belongs to the range its first byte
+// falls into, so each thread can read its lines without any locking.
+// Other inputs are read under a lock, BATCH lines at a time.
+//
+// Once cancelled, threads see the end of the input the next time they
+// need a new range or batch.
+
 struct ThreadedSeqFile : public obj::SeqBase {
 
+    static const size_t CHUNK = 1024*1024;
+    static const size_t BATCH = 4096;
+
+    struct cursor_t {
+        const char* i;
+        const char* e;
+
+        std::vector<std::string> batch;
+        size_t n;
+
+        cursor_t() : i(nullptr), e(nullptr), n(0) {}
+    };
+
     obj::String* holder() {
         static thread_local obj::String ret;
         return &ret;
     }
 
+    cursor_t& cursor() {
+        static thread_local cursor_t ret;
+        return ret;
+    }
+
     std::mutex mutex;
     funcs::Linereader reader;
-    
-    ThreadedSeqFile(std::istream& infile) : reader(infile) {}
+    std::atomic<size_t> chunk;
+    std::atomic<bool> cancelled;
 
-    obj::Object* next() {
-        std::lock_guard<std::mutex> l(mutex);
+    ThreadedSeqFile(const std::string& infile) : reader(infile), chunk(0), cancelled(false) {}
+
+    void cancel() {
+        cancelled = true;
+    }
+
+    bool claim(cursor_t& c) {
+
+        if (cancelled)
+            return false;
+
+        size_t size = reader.mape - reader.mapb;
+        size_t a = chunk.fetch_add(CHUNK);
+
+        if (a >= size)
+            return false;
+
+        const char* b = reader.mapb + a;
+        const char* e = reader.mapb + std::min(size, a + CHUNK);
+
+        if (a > 0) {
+            b = scan::find_byte(b - 1, reader.mape, '\n');
+
+            if (b != reader.mape)
+                ++b;
+        }
+
+        reader.prefault(b, e);
+
+        c.i = b;
+        c.e = e;
+        return true;
+    }
+
+    obj::Object* next_mapped() {
+
+        cursor_t& c = cursor();
+
+        while (c.i >= c.e) {
+            if (!claim(c))
+                return nullptr;
+        }
+
+        const char* i = scan::find_byte(c.i, reader.mape, '\n');
 
-        bool ok = reader.getline(holder()->v);
+        holder()->v.assign(c.i, i);
 
-        if (!ok) return nullptr;
+        c.i = (i == reader.mape ? i : i + 1);
 
         return holder();
     }
+
+    obj::Object* next_batched() {
+
+        cursor_t& c = cursor();
+
+        if (c.n >= c.batch.size()) {
+
+            c.batch.resize(BATCH);
+            c.n = 0;
+
+            size_t n = 0;
+
+            if (!cancelled) {
+                std::lock_guard<std::mutex> l(mutex);
+
+                while (n < BATCH && reader.getline(c.batch[n])) {
+                    ++n;
+                }
+            }
+
+            c.batch.resize(n);
+
+            if (n == 0)
+                return nullptr;
+        }
+
+        std::swap(holder()->v, c.batch[c.n]);
+        ++c.n;
+
+        return holder();
+    }
+
+    obj::Object* next() {
+
+        if (reader.mapped)
+            return next_mapped();
+
+        return next_batched();
+    }
+
+    UInt skip(UInt n) {
+
+        if (!reader.mapped)
+            return obj::SeqBase::skip(n);
+
+        cursor_t& c = cursor();
+        UInt done = 0;
+
+        while (done < n) {
+
+            while (c.i >= c.e) {
+                if (!claim(c))
+                    return done;
+            }
+
+            size_t left = n - done;
+            const char* i = scan::skip_byte(c.i, c.e, '\n', left);
+
+            done = n - left;
+
+            // The last line starting in this range ends in the next one.
+            if (left > 0 && i[-1] != '\n') {
+                i = scan::find_byte(i, reader.mape, '\n');
+
+                if (i != reader.mape)
+                    ++i;
+
+                ++done;
+            }
+
+            c.i = i;
+        }
+
+        return done;
+    }
 };
 
+// Results are handed from each scatter thread to the gather stage through
+// a bounded single-producer/single-consumer ring of batches. Results are
+// cloned into the batch so that the producer can carry on immediately;
+// types that can't be cloned (anything containing a sequence) are passed
+// one at a time, and the producer waits until the consumer is done with
+// each one before asking for the next.
+//
+// Both sides only sleep when there is nothing to do: the sleeper raises a
+// 'waiting' flag and re-checks the counters before blocking, and the other
+// side takes the lock to notify only when it sees that flag.
+//
+// The gather stage can finish without reading everything (as in 'head' or
+// 'while'); the scatter threads and the input are then cancelled instead
+// of being waited for.
+
 struct ThreadGroupSeq : public obj::SeqBase {
 
-    struct syncvar_t {
-        obj::Object* result;
-        std::condition_variable can_produce;
+    static const size_t BATCH = 256;
+    static const size_t SLOTS = 16;
+
+    struct sleeper_t {
         std::mutex mutex;
-        bool finished;
+        std::condition_variable cv;
+        std::atomic<bool> waiting;
+
+        sleeper_t() : waiting(false) {}
+
+        template <typename F>
+        void sleep_until(F ready) {
+            std::unique_lock<std::mutex> l(mutex);
+            waiting = true;
 
-        syncvar_t() : result(nullptr), finished(false) {}
+            while (!ready()) {
+                cv.wait(l);
+            }
+
+            waiting = false;
+        }
+
+        void wake() {
+            if (waiting) {
+                std::lock_guard<std::mutex> l(mutex);
+                cv.notify_one();
+            }
+        }
     };
 
-    std::vector< std::unique_ptr<syncvar_t> > syncs;
-    std::vector<syncvar_t*> queued;
+    struct ring_t {
+        std::vector<obj::Object*> slots[SLOTS];
+
+        std::atomic<size_t> pushed;
+        std::atomic<size_t> released;
+        std::atomic<bool> finished;
+
+        size_t popped;
+
+        sleeper_t producer;
+
+        ring_t() : pushed(0), released(0), finished(false), popped(0) {}
+    };
+
+    std::vector< std::unique_ptr<ring_t> > rings;
+    std::vector<ring_t*> queued;
     std::vector<std::thread> threads;
-    size_t nthreads;
-    ssize_t last_used_thread;
 
-    template <typename API, typename T>
-    void threadfun(API& api, T& code, obj::Object*& seq, obj::Object* input, syncvar_t* sync) try {
+    sleeper_t consumer;
 
-        {
-            std::unique_lock<std::mutex> l(sync->mutex);
+    ThreadedSeqFile* input;
+    std::atomic<bool> cancelled;
+
+    bool cloned;
+    size_t limit;
 
-            obj::Object* r = api.run(code, input);
+    std::vector<obj::Object*> current;
+    size_t current_i;
+    ring_t* current_ring;
+    size_t last_used_ring;
 
-            if (seq == nullptr) {
-                seq = r;
+    static bool clonable(const Type& t) {
 
-            } else {
-                seq->wrap(r);
+        if (t.type == Type::SEQ)
+            return false;
+
+        if (t.tuple) {
+            for (const Type& x : *t.tuple) {
+                if (!clonable(x))
+                    return false;
             }
         }
 
+        return true;
+    }
+
+    void push(ring_t* ring, std::vector<obj::Object*>& batch) {
+
+        size_t n = ring->pushed;
+
+        std::swap(ring->slots[n % SLOTS], batch);
+        ring->pushed = n + 1;
+
+        consumer.wake();
+    }
+
+    template <typename API, typename T>
+    void threadfun(API& api, T& code, obj::Object*& seq, obj::Object* input, ring_t* ring) try {
+
+        obj::Object* r = api.run(code, input);
+
+        if (seq == nullptr) {
+            seq = r;
+
+        } else {
+            seq->wrap(r);
+        }
+
+        size_t batchsize = (cloned ? BATCH : 1);
+        std::vector<obj::Object*> batch;
+
         while (1) {
-            std::unique_lock<std::mutex> l(sync->mutex);
 
-            while (sync->result) {
-                sync->can_produce.wait(l);
-            }
+            obj::Object* x = seq->next();
 
-            sync->result = seq->next();
+            if (!x) {
 
-            if (!sync->result) {
+                if (!batch.empty())
+                    push(ring, batch);
 
-                sync->finished = true;
                 break;
             }
+
+            batch.push_back(cloned ? x->clone() : x);
+
+            if (batch.size() >= batchsize) {
+
+                push(ring, batch);
+
+                ring->producer.sleep_until([&]() { return cancelled || ring->pushed - ring->released < limit; });
+
+                if (cancelled)
+                    break;
+            }
         }
 
+        ring->finished = true;
+        consumer.wake();
+
     } catch (std::exception& e) {
         std::cerr << "ERROR: " << e.what() << std::endl;
         std::exit(1);
@@ -89,15 +332,20 @@ struct ThreadGroupSeq : public obj::SeqBase {
     }
 
     template <typename API, typename T>
-    ThreadGroupSeq(API& api, std::vector<T>& codes, std::vector<obj::Object*>& seqs, obj::Object* input) :
-        nthreads(codes.size()), last_used_thread(-1) {
+    ThreadGroupSeq(API& api, std::vector<T>& codes, std::vector<obj::Object*>& seqs, ThreadedSeqFile* in) :
+        input(in), cancelled(false), current_i(0), current_ring(nullptr), last_used_ring(0) {
 
-        syncs.resize(nthreads);
+        size_t nthreads = codes.size();
+
+        cloned = clonable(unwrap_seq(codes[0].result));
+        limit = (cloned ? SLOTS : 1);
+
+        rings.resize(nthreads);
         queued.resize(nthreads);
 
         for (size_t i = 0; i < nthreads; ++i) {
-            syncs[i].reset(new syncvar_t);
-            queued[i] = syncs[i].get();
+            rings[i].reset(new ring_t);
+            queued[i] = rings[i].get();
         }
 
         for (size_t i = 0; i < nthreads; ++i) {
@@ -107,58 +355,231 @@ struct ThreadGroupSeq : public obj::SeqBase {
     }
 
     ~ThreadGroupSeq() {
+
+        cancel();
+
         for (auto& t : threads) {
             t.join();
         }
+
+        release();
+
+        if (cloned) {
+            for (auto& ring : rings) {
+                for (; ring->popped < ring->pushed; ++(ring->popped)) {
+                    for (obj::Object* x : ring->slots[ring->popped % SLOTS]) {
+                        delete x;
+                    }
+                }
+            }
+        }
     }
 
-    obj::Object* next() {
+    void cancel() {
 
-        if (last_used_thread >= 0) {
-            syncvar_t* luts = queued[last_used_thread];
+        input->cancel();
+        cancelled = true;
 
-            luts->result = nullptr;
-            luts->mutex.unlock();
-            luts->can_produce.notify_one();
+        for (auto& ring : rings) {
+            ring->producer.wake();
         }
+    }
 
-        size_t n = last_used_thread;
+    void release() {
 
-        while (1) {
-            ++n;
-            n = n % nthreads;
+        if (cloned) {
+            for (obj::Object* x : current) {
+                delete x;
+            }
 
-            syncvar_t* sync = queued[n];
+        } else if (current_ring) {
+            current_ring->released = current_ring->popped;
+            current_ring->producer.wake();
+        }
 
-            if (!sync->mutex.try_lock())
-                continue;
+        current.clear();
+        current_i = 0;
+        current_ring = nullptr;
+    }
+
+    bool pop() {
+
+        size_t n = queued.size();
+
+        for (size_t j = 0; j < n; ++j) {
+
+            size_t i = (last_used_ring + 1 + j) % n;
+            ring_t* ring = queued[i];
+
+            if (ring->pushed == ring->popped) {
+
+                if (ring->finished && ring->pushed == ring->popped) {
+                    queued.erase(queued.begin() + i);
+                    last_used_ring = i + queued.size() - 1;
+                    return pop();
+                }
 
-            if (!sync->finished && !sync->result) {
-                sync->mutex.unlock();
                 continue;
             }
 
-            if (sync->finished) {
-                sync->mutex.unlock();
-                last_used_thread = -1;
-                --nthreads;
+            std::swap(current, ring->slots[ring->popped % SLOTS]);
+            ++(ring->popped);
 
-                queued.erase(queued.begin() + n);
+            current_ring = ring;
+            last_used_ring = i;
+
+            if (cloned) {
+                ring->released = ring->popped;
+                ring->producer.wake();
+            }
+
+            return true;
+        }
+
+        return false;
+    }
 
-                if (queued.empty())
-                    return nullptr;
+    bool ready() {
 
-                return next();
+        for (ring_t* ring : queued) {
+            if (ring->pushed != ring->popped || ring->finished)
+                return true;
+        }
+
+        return queued.empty();
+    }
+
+    obj::Object* next() {
+
+        if (current_i < current.size()) {
+            return current[current_i++];
+        }
+
+        release();
+
+        while (!queued.empty()) {
+
+            if (pop()) {
+                return current[current_i++];
             }
 
-            last_used_thread = n;
-                
-            return sync->result;
+            if (queued.empty())
+                break;
+
+            consumer.sleep_until([this]() { return ready(); });
         }
+
+        return nullptr;
     }
 
 };
 
+// When the scatter expression produces a map and the gather expression
+// starts by building a map out of its input (as in 'count.map.@'), the
+// per-thread maps are merged directly: pairwise, in log2(N) rounds, with
+// the merges of each round running in parallel. The gather expression
+// then continues from the merged map.
+
+bool reads_var(const std::vector<Command>& commands, UInt var) {
+
+    for (const auto& c : commands) {
+
+        if (c.cmd == Command::VAR && c.arg.uint == var)
+            return true;
+
+        for (const auto& j : c.closure) {
+            if (reads_var(j.code, var))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool make_reducer(const Type& scattered, std::vector<Command>& gathered) {
+
+    if (scattered.type != Type::MAP || gathered.size() < 2)
+        return false;
+
+    Command& var = gathered[0];
+    Command& fun = gathered[1];
+
+    if (var.cmd != Command::VAR || var.arg.uint != 0 ||
+        fun.cmd != Command::FUN || !(fun.arg.str == strings().add("map")) ||
+        fun.type != scattered)
+        return false;
+
+    std::vector<Command> rest(gathered.begin() + 2, gathered.end());
+
+    if (reads_var(rest, 0))
+        return false;
+
+    var.type = scattered;
+    gathered.erase(gathered.begin() + 1);
+    return true;
+}
+
+template <bool SORTED>
+struct ThreadReduce {
+
+    typedef obj::MapObject<SORTED> map_t;
+
+    template <typename API, typename T>
+    static void scatterfun(API& api, T& code, obj::Object* input, obj::Object*& out) try {
+
+        out = api.run(code, input);
+
+    } catch (std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        std::exit(1);
+
+    } catch (...) {
+        std::cerr << "UNKNOWN ERROR." << std::endl;
+        std::exit(1);
+    }
+
+    static void mergefun(map_t* a, map_t* b) {
+        a->merge_move(*b);
+    }
+
+    template <typename API, typename T>
+    static obj::Object* run(API& api, std::vector<T>& codes, obj::Object* input) {
+
+        size_t n = codes.size();
+        std::vector<obj::Object*> maps(n);
+
+        {
+            std::vector<std::thread> threads;
+
+            for (size_t i = 0; i < n; ++i) {
+                threads.emplace_back(&ThreadReduce::scatterfun<API, T>,
+                                     std::ref(api), std::ref(codes[i]), input, std::ref(maps[i]));
+            }
+
+            for (auto& t : threads) {
+                t.join();
+            }
+        }
+
+        for (size_t stride = 1; stride < n; stride *= 2) {
+
+            std::vector<std::thread> threads;
+
+            for (size_t i = 0; i + stride < n; i += 2 * stride) {
+                threads.emplace_back(&ThreadReduce::mergefun,
+                                     (map_t*)maps[i], (map_t*)maps[i + stride]);
+            }
+
+            for (auto& t : threads) {
+                t.join();
+            }
+        }
+
+        maps[0]->merge_end();
+        return maps[0];
+    }
+};
+
 }
 
 template <bool SORTED>
@@ -192,7 +613,7 @@ void run_threaded(size_t seed, const std::string& program, size_t nthreads,
 
     typedef typename tab::API<SORTED>::compiled_t compiled_t;
 
-    tab::obj::Object* input = new tab::ThreadedSeqFile(file_or_stdin(infile));
+    tab::ThreadedSeqFile* input = new tab::ThreadedSeqFile(infile);
 
     std::vector<compiled_t> codes;
     std::vector<tab::obj::Object*> seqs;
@@ -200,12 +621,16 @@ void run_threaded(size_t seed, const std::string& program, size_t nthreads,
     codes.resize(nthreads);
     seqs.resize(nthreads);
 
+    tab::Type scattered;
+
     for (size_t n = 0; n < nthreads; ++n) {
 
         auto& code = codes[n];
 
         api.compile(scatter.begin(), scatter.end(), intype, code, (n == 0 ? debuglevel : 0));
 
+        scattered = code.result;
+
         seqs[n] = (tab::functions().seqmaker)(code.result);
 
         if (seqs[n]) {
@@ -216,11 +641,25 @@ void run_threaded(size_t seed, const std::string& program, size_t nthreads,
     compiled_t gathered;
     api.compile(gather.begin(), gather.end(), codes[0].result, gathered, debuglevel);
 
+    tab::obj::Printer p;
+
+    if (tab::make_reducer(scattered, gathered.commands)) {
+
+        tab::execute_lower(gathered.commands, gathered.code);
+
+        tab::obj::Object* merged = tab::ThreadReduce<SORTED>::run(api, codes, input);
+
+        tab::obj::Object* output = api.run(gathered, merged);
+
+        output->print(p);
+        p.nl();
+        return;
+    }
+
     tab::ThreadGroupSeq* tgs = new tab::ThreadGroupSeq(api, codes, seqs, input);
 
     tab::obj::Object* output = api.run(gathered, tgs);
 
-    tab::obj::Printer p;
     output->print(p);
     p.nl();
 